@@ -1865,6 +1865,70 @@ function Regression::Math()
 	print("   13725      > -2147483648:   " + ( 13725      > -2147483648));
 }
 
+function Regression::CountValueMismatches(list, other)
+{
+	local mismatches = 0;
+	foreach (item, value in list) {
+		if (!other.HasItem(item) || other.GetValue(item) != value) mismatches++;
+	}
+	return mismatches + other.Count() - list.Count();
+}
+
+function Regression::NativeValuators()
+{
+	local list = AITileList();
+	list.AddRectangle(41895 - 256 * 2, 256 * 2 + 41895 + 8);
+	local native = AITileList();
+	native.AddList(list);
+	print("");
+	print("--TileList native valuators--");
+	print("  Count():             " + native.Count());
+	list.Valuate(AITile.GetSlope);
+	native.ValuateSlope();
+	print("  ValuateSlope():                   " + this.CountValueMismatches(list, native) + " mismatches");
+	list.Valuate(AITile.IsBuildable);
+	native.ValuateBuildable();
+	print("  ValuateBuildable():               " + this.CountValueMismatches(list, native) + " mismatches");
+	list.Valuate(AITile.GetDistanceManhattanToTile, 30000);
+	native.ValuateDistanceManhattanToTile(30000);
+	print("  ValuateDistanceManhattanToTile(): " + this.CountValueMismatches(list, native) + " mismatches");
+	list.Valuate(AITile.GetDistanceSquareToTile, 30000);
+	native.ValuateDistanceSquareToTile(30000);
+	print("  ValuateDistanceSquareToTile():    " + this.CountValueMismatches(list, native) + " mismatches");
+	list.Valuate(AITile.GetCargoAcceptance, 0, 1, 1, 3);
+	native.ValuateCargoAcceptance(0, 1, 1, 3);
+	print("  ValuateCargoAcceptance():         " + this.CountValueMismatches(list, native) + " mismatches");
+	native.KeepAboveValue(10);
+	print("  KeepAboveValue(10):  done");
+	print("  Count():             " + native.Count());
+	print("  ListDump:");
+	for (local i = native.Begin(); !native.IsEnd(); i = native.Next()) {
+		print("    " + i + " => " + native.GetValue(i));
+	}
+
+	list = AIVehicleList();
+	native = AIVehicleList();
+	print("");
+	print("--VehicleList native valuators--");
+	print("  Count():             " + native.Count());
+	list.Valuate(AIVehicle.GetProfitThisYear);
+	native.ValuateProfitThisYear();
+	print("  ValuateProfitThisYear(): " + this.CountValueMismatches(list, native) + " mismatches");
+	list.Valuate(AIVehicle.GetProfitLastYear);
+	native.ValuateProfitLastYear();
+	print("  ValuateProfitLastYear(): " + this.CountValueMismatches(list, native) + " mismatches");
+	list.Valuate(AIVehicle.GetAge);
+	native.ValuateAge();
+	print("  ValuateAge():            " + this.CountValueMismatches(list, native) + " mismatches");
+	list.Valuate(AIVehicle.GetState);
+	native.ValuateState();
+	print("  ValuateState():          " + this.CountValueMismatches(list, native) + " mismatches");
+	print("  State ListDump:");
+	for (local i = native.Begin(); !native.IsEnd(); i = native.Next()) {
+		print("    " + i + " => " + native.GetValue(i));
+	}
+}
+
 function Regression::Start()
 {
 	this.TestInit();
@@ -1931,5 +1995,8 @@ function Regression::Start()
 	print("  IsEventWaiting:        false");
 
 	this.Math();
+
+	/* The native valuators are tested last, so they do not change the timing of the tests above. */
+	this.NativeValuators();
 }
 
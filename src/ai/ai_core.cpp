@@ -10,16 +10,21 @@
 #include "../stdafx.h"
 #include "../core/backup_type.hpp"
 #include "../core/bitmath_func.hpp"
+#include "../core/random_func.hpp"
 #include "../company_base.h"
 #include "../company_func.h"
 #include "../network/network.h"
 #include "../window_func.h"
 #include "../framerate_type.h"
+#include "../settings_type.h"
+#include "../thread_pool.h"
+#include "../script/squirrel.hpp"
 #include "ai_scanner.hpp"
 #include "ai_instance.hpp"
 #include "ai_config.hpp"
 #include "ai_info.hpp"
 #include "ai.hpp"
+#include <vector>
 
 #include "../safeguards.h"
 
@@ -64,6 +69,45 @@
 	return;
 }
 
+/**
+ * Run the AIs, resuming their scripts in parallel on worker threads. The DoCommands of
+ * the scripts are only tested while they run, and executed afterwards in company order.
+ * @param cur_company Backup of the current company, to change to the company of each AI.
+ */
+static void ThreadedGameLoop(Backup<CompanyID> &cur_company)
+{
+	static ThreadPool thread_pool("ottd:ai");
+
+	std::vector<const Company *> resume;
+	for (const Company *c : Company::Iterate()) {
+		if (c->is_ai) {
+			cur_company.Change(c->index);
+			if (c->ai_instance->StartGameLoop()) {
+				c->ai_instance->SetThreadedRandomSeed(Random());
+				resume.push_back(c);
+			} else {
+				PerformanceMeasurer::Paused((PerformanceElement)(PFE_AI0 + c->index));
+			}
+		} else {
+			PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+		}
+	}
+
+	ScriptNativeScope::SetThreaded(true);
+	thread_pool.Run((uint)resume.size(), [&resume](uint index) {
+		const Company *c = resume[index];
+		PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
+		ScriptNativeScope::SetThreadCompany(c->index);
+		c->ai_instance->ResumeGameLoop(true);
+	});
+	ScriptNativeScope::SetThreaded(false);
+
+	for (const Company *c : resume) {
+		cur_company.Change(c->index);
+		c->ai_instance->FinishGameLoop();
+	}
+}
+
 /* static */ void AI::GameLoop()
 {
 	/* If we are in networking, only servers run this function, and that only if it is allowed */
@@ -75,13 +119,17 @@
 	if ((AI::frame_counter & ((1 << (4 - _settings_game.difficulty.competitor_speed)) - 1)) != 0) return;
 
 	Backup<CompanyID> cur_company(_current_company, FILE_LINE);
-	for (const Company *c : Company::Iterate()) {
-		if (c->is_ai) {
-			PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
-			cur_company.Change(c->index);
-			c->ai_instance->GameLoop();
-		} else {
-			PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+	if (_settings_client.gui.threaded_ai) {
+		ThreadedGameLoop(cur_company);
+	} else {
+		for (const Company *c : Company::Iterate()) {
+			if (c->is_ai) {
+				PerformanceMeasurer framerate((PerformanceElement)(PFE_AI0 + c->index));
+				cur_company.Change(c->index);
+				c->ai_instance->GameLoop();
+			} else {
+				PerformanceMeasurer::SetInactive((PerformanceElement)(PFE_AI0 + c->index));
+			}
 		}
 	}
 	cur_company.Restore();
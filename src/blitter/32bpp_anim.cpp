@@ -259,6 +259,8 @@ void Blitter_32bppAnim::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomL
 		return;
 	}
 
+	this->MarkAnimated(this->anim_buf + this->ScreenToAnimOffset((uint32 *)bp->dst) + bp->top * this->anim_buf_pitch + bp->left, bp->width, bp->height);
+
 	switch (mode) {
 		default: NOT_REACHED();
 		case BM_NORMAL:       Draw<BM_NORMAL>      (bp, zoom); return;
@@ -317,7 +319,9 @@ void Blitter_32bppAnim::SetPixel(void *video, int x, int y, uint8 colour)
 	/* Set the colour in the anim-buffer too, if we are rendering to the screen */
 	if (_screen_disable_anim) return;
 
-	this->anim_buf[this->ScreenToAnimOffset((uint32 *)video) + x + y * this->anim_buf_pitch] = colour | (DEFAULT_BRIGHTNESS << 8);
+	uint16 *anim = this->anim_buf + this->ScreenToAnimOffset((uint32 *)video) + x + y * this->anim_buf_pitch;
+	*anim = colour | (DEFAULT_BRIGHTNESS << 8);
+	if (colour >= PALETTE_ANIM_START) this->MarkAnimated(anim, 1, 1);
 }
 
 void Blitter_32bppAnim::DrawLine(void *video, int x, int y, int x2, int y2, int screen_width, int screen_height, uint8 colour, int width, int dash)
@@ -331,9 +335,11 @@ void Blitter_32bppAnim::DrawLine(void *video, int x, int y, int x2, int y2, int
 	} else {
 		uint16 * const offset_anim_buf = this->anim_buf + this->ScreenToAnimOffset((uint32 *)video);
 		const uint16 anim_colour = colour | (DEFAULT_BRIGHTNESS << 8);
+		const bool animated = colour >= PALETTE_ANIM_START;
 		this->DrawLineGeneric(x, y, x2, y2, screen_width, screen_height, width, dash, [&](int x, int y) {
 			*((Colour *)video + x + y * _screen.pitch) = c;
 			offset_anim_buf[x + y * this->anim_buf_pitch] = anim_colour;
+			if (animated) this->MarkAnimated(&offset_anim_buf[x + y * this->anim_buf_pitch], 1, 1);
 		});
 	}
 }
@@ -348,6 +354,7 @@ void Blitter_32bppAnim::DrawRect(void *video, int width, int height, uint8 colou
 
 	Colour colour32 = LookupColourInPalette(colour);
 	uint16 *anim_line = this->ScreenToAnimOffset((uint32 *)video) + this->anim_buf;
+	if (colour >= PALETTE_ANIM_START) this->MarkAnimated(anim_line, width, height);
 
 	do {
 		Colour *dst = (Colour *)video;
@@ -372,6 +379,7 @@ void Blitter_32bppAnim::CopyFromBuffer(void *video, const void *src, int width,
 	Colour *dst = (Colour *)video;
 	const uint32 *usrc = (const uint32 *)src;
 	uint16 *anim_line = this->ScreenToAnimOffset((uint32 *)video) + this->anim_buf;
+	this->MarkAnimated(anim_line, width, height);
 
 	for (; height > 0; height--) {
 		/* We need to keep those for palette animation. */
@@ -433,6 +441,9 @@ void Blitter_32bppAnim::ScrollBuffer(void *video, int &left, int &top, int &widt
 	assert(video >= _screen.dst_ptr && video <= (uint32 *)_screen.dst_ptr + _screen.width + _screen.height * _screen.pitch);
 	uint16 *dst, *src;
 
+	/* The scrolled animated colours may end up anywhere in the scrolled area. */
+	this->MarkAnimated(this->anim_buf + left + top * this->anim_buf_pitch, width, height);
+
 	/* We need to scroll the anim-buffer too */
 	if (scroll_y > 0) {
 		dst = this->anim_buf + left + (top + height - 1) * this->anim_buf_pitch;
@@ -483,6 +494,30 @@ int Blitter_32bppAnim::BufferSize(int width, int height)
 	return width * height * (sizeof(uint32) + sizeof(uint16));
 }
 
+/**
+ * Animate the palette of a part of a line of the screen.
+ * @param dst The first pixel of the part on the screen.
+ * @param anim The first pixel of the part in the animation buffer.
+ * @param width The number of pixels in the part.
+ * @return Whether the part contains any animated colours.
+ */
+bool Blitter_32bppAnim::PaletteAnimateChunk(Colour *dst, const uint16 *anim, int width)
+{
+	bool animated = false;
+	for (int x = width; x != 0 ; x--) {
+		uint16 value = *anim;
+		uint8 colour = GB(value, 0, 8);
+		if (colour >= PALETTE_ANIM_START) {
+			/* Update this pixel */
+			*dst = this->AdjustBrightness(LookupColourInPalette(colour), GB(value, 8, 8));
+			animated = true;
+		}
+		dst++;
+		anim++;
+	}
+	return animated;
+}
+
 void Blitter_32bppAnim::PaletteAnimate(const Palette &palette)
 {
 	assert(!_screen_disable_anim);
@@ -493,30 +528,36 @@ void Blitter_32bppAnim::PaletteAnimate(const Palette &palette)
 	 *  Especially when going between toyland and non-toyland. */
 	assert(this->palette.first_dirty == PALETTE_ANIM_START || this->palette.first_dirty == 0);
 
-	const uint16 *anim = this->anim_buf;
-	Colour *dst = (Colour *)_screen.dst_ptr;
-
-	/* Let's walk the anim buffer and try to find the pixels */
+	/* Only walk the parts of the anim buffer that might contain animated colours,
+	 * and forget about the parts that turn out to have none. The screen is made
+	 * dirty per band of lines, so the backend only redraws what got animated. */
 	const int width = this->anim_buf_width;
-	const int pitch_offset = _screen.pitch - width;
-	const int anim_pitch_offset = this->anim_buf_pitch - width;
-	for (int y = this->anim_buf_height; y != 0 ; y--) {
-		for (int x = width; x != 0 ; x--) {
-			uint16 value = *anim;
-			uint8 colour = GB(value, 0, 8);
-			if (colour >= PALETTE_ANIM_START) {
-				/* Update this pixel */
-				*dst = this->AdjustBrightness(LookupColourInPalette(colour), GB(value, 8, 8));
+	for (int band_top = 0; band_top < this->anim_buf_height; band_top += ANIM_CHUNK_SIZE) {
+		const int band_bottom = min(band_top + ANIM_CHUNK_SIZE, this->anim_buf_height);
+		int left = width;
+		int right = 0;
+
+		for (int y = band_top; y < band_bottom; y++) {
+			byte *chunk = &this->anim_chunks[y * this->anim_chunks_pitch];
+			Colour *dst = (Colour *)_screen.dst_ptr + y * _screen.pitch;
+			const uint16 *anim = this->anim_buf + y * this->anim_buf_pitch;
+
+			for (int c = 0; c < this->anim_chunks_pitch; c++) {
+				if (chunk[c] == 0) continue;
+
+				const int x = c * ANIM_CHUNK_SIZE;
+				const int chunk_width = min(ANIM_CHUNK_SIZE, width - x);
+				if (this->PaletteAnimateChunk(dst + x, anim + x, chunk_width)) {
+					left = min(left, x);
+					right = max(right, x + chunk_width);
+				} else {
+					chunk[c] = 0;
+				}
 			}
-			dst++;
-			anim++;
 		}
-		dst += pitch_offset;
-		anim += anim_pitch_offset;
-	}
 
-	/* Make sure the backend redraws the whole screen */
-	VideoDriver::GetInstance()->MakeDirty(0, 0, _screen.width, _screen.height);
+		if (left < right) VideoDriver::GetInstance()->MakeDirty(left, band_top, right - left, band_bottom - band_top);
+	}
 }
 
 Blitter::PaletteAnimation Blitter_32bppAnim::UsePaletteAnimation()
@@ -535,6 +576,10 @@ void Blitter_32bppAnim::PostResize()
 		this->anim_buf_pitch = (_screen.width + 7) & ~7;
 		this->anim_alloc = CallocT<uint16>(this->anim_buf_pitch * this->anim_buf_height + 8);
 
+		/* The new buffer is empty, so nothing is animated yet */
+		this->anim_chunks_pitch = (this->anim_buf_width + ANIM_CHUNK_SIZE - 1) / ANIM_CHUNK_SIZE;
+		this->anim_chunks.assign(this->anim_chunks_pitch * this->anim_buf_height, 0);
+
 		/* align buffer to next 16 byte boundary */
 		this->anim_buf = reinterpret_cast<uint16 *>((reinterpret_cast<uintptr_t>(this->anim_alloc) + 0xF) & (~0xF));
 	}
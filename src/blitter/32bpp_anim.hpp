@@ -12,23 +12,32 @@
 
 #include "32bpp_optimized.hpp"
 
+#include <vector>
+
 /** The optimised 32 bpp blitter with palette animation. */
 class Blitter_32bppAnim : public Blitter_32bppOptimized {
 protected:
+	static const int ANIM_CHUNK_SIZE = 64; ///< Width of the parts of a line of the animation buffer for which is tracked whether they contain animated colours; a multiple of 8.
+
 	uint16 *anim_buf;    ///< In this buffer we keep track of the 8bpp indexes so we can do palette animation
 	void *anim_alloc;    ///< The raw allocated buffer, not necessarily aligned correctly
 	int anim_buf_width;  ///< The width of the animation buffer.
 	int anim_buf_height; ///< The height of the animation buffer.
 	int anim_buf_pitch;  ///< The pitch of the animation buffer (width rounded up to 16 byte boundary).
+	std::vector<byte> anim_chunks; ///< For every #ANIM_CHUNK_SIZE pixels of every line of the animation buffer, whether they may contain animated colours.
+	int anim_chunks_pitch;         ///< The number of chunks per line in #anim_chunks.
 	Palette palette;     ///< The current palette.
 
+	virtual bool PaletteAnimateChunk(Colour *dst, const uint16 *anim, int width);
+
 public:
 	Blitter_32bppAnim() :
 		anim_buf(nullptr),
 		anim_alloc(nullptr),
 		anim_buf_width(0),
 		anim_buf_height(0),
-		anim_buf_pitch(0)
+		anim_buf_pitch(0),
+		anim_chunks_pitch(0)
 	{
 		this->palette = _cur_palette;
 	}
@@ -68,6 +77,32 @@ public:
 		return across + (lines * this->anim_buf_pitch);
 	}
 
+	/**
+	 * Remember that a part of the animation buffer may contain animated colours,
+	 * so PaletteAnimate looks at it.
+	 * @param anim The top left of the part in the animation buffer.
+	 * @param width The width of the part.
+	 * @param height The height of the part.
+	 * @note This is not thread safe; see the note at #Blitter.
+	 */
+	inline void MarkAnimated(const uint16 *anim, int width, int height)
+	{
+		int offset = anim - this->anim_buf;
+		if (offset < 0) return;
+
+		int top = offset / this->anim_buf_pitch;
+		int left = offset % this->anim_buf_pitch;
+		int right = min(left + width, this->anim_buf_width);
+		int bottom = min(top + height, this->anim_buf_height);
+		if (left >= right || top >= bottom) return;
+
+		int first = left / ANIM_CHUNK_SIZE;
+		int count = (right - 1) / ANIM_CHUNK_SIZE - first + 1;
+		for (int y = top; y < bottom; y++) {
+			memset(&this->anim_chunks[y * this->anim_chunks_pitch + first], 1, count);
+		}
+	}
+
 	template <BlitterMode mode> void Draw(const Blitter::BlitterParams *bp, ZoomLevel zoom);
 };
 
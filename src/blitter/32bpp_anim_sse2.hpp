@@ -25,8 +25,10 @@
 
 /** A partially 32 bpp blitter with palette animation. */
 class Blitter_32bppSSE2_Anim : public Blitter_32bppAnim {
+protected:
+	bool PaletteAnimateChunk(Colour *dst, const uint16 *anim, int width) override;
+
 public:
-	void PaletteAnimate(const Palette &palette) override;
 	const char *GetName() override { return "32bpp-sse2-anim"; }
 };
 
@@ -366,6 +366,12 @@ IGNORE_UNINITIALIZED_WARNING_STOP
 void Blitter_32bppSSE4_Anim::Draw(Blitter::BlitterParams *bp, BlitterMode mode, ZoomLevel zoom)
 {
 	const Blitter_32bppSSE_Base::SpriteFlags sprite_flags = ((const Blitter_32bppSSE_Base::SpriteData *) bp->sprite)->flags;
+
+	/* Sprites without animated colours are drawn without animation in the normal and colour remap modes. */
+	if (!_screen_disable_anim && ((sprite_flags & SF_NO_ANIM) == 0 || (mode != BM_NORMAL && mode != BM_COLOUR_REMAP))) {
+		this->MarkAnimated(this->anim_buf + this->ScreenToAnimOffset((uint32 *)bp->dst) + bp->top * this->anim_buf_pitch + bp->left, bp->width, bp->height);
+	}
+
 	switch (mode) {
 		default: {
 bm_normal:
@@ -24,6 +24,10 @@ enum BlitterMode {
 
 /**
  * How all blitters should look like. Extend this class to make your own.
+ * @note Drawing may update state of the blitter that is shared by the whole
+ *  video buffer, e.g. which parts of it contain animated colours. So only one
+ *  thread may draw at a time: the game thread, or the draw thread of the video
+ *  driver while holding its draw lock. Other threads must not call the blitter.
  */
 class Blitter {
 public:
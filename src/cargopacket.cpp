@@ -692,9 +692,11 @@ void StationCargoList::Append(CargoPacket *cp, StationID next)
 	assert(cp != nullptr);
 	this->AddToCache(cp);
 
+	/* Only look at the most recent packets; older ones are merged by Compact(). */
 	StationCargoPacketMap::List &list = this->packets[next];
+	uint depth = 0;
 	for (StationCargoPacketMap::List::reverse_iterator it(list.rbegin());
-			it != list.rend(); it++) {
+			it != list.rend() && depth < MERGE_DEPTH; it++, depth++) {
 		if (StationCargoList::TryMerge(*it, cp)) return;
 	}
 
@@ -702,6 +704,43 @@ void StationCargoList::Append(CargoPacket *cp, StationID next)
 	list.push_back(cp);
 }
 
+/**
+ * Merge packets waiting for the same next hop that come from the same source
+ * and have been in transit for about as long. Every vehicle unloading at a
+ * station adds packets with its own days in transit, so without this busy
+ * stations collect huge numbers of small packets. The days in transit of the
+ * merged packets are averaged, weighted by their amount of cargo.
+ */
+void StationCargoList::Compact()
+{
+	CargoPacket *candidates[COMPACT_CANDIDATES];
+
+	for (StationCargoPacketMap::MapIterator it = this->packets.StationCargoPacketMap::Map::begin(); it != this->packets.StationCargoPacketMap::Map::end(); ++it) {
+		StationCargoPacketMap::List &list = it->second;
+		if (list.size() < 2) continue;
+
+		MemSetT(candidates, 0, COMPACT_CANDIDATES);
+		for (StationCargoPacketMap::ListIterator list_it = list.begin(); list_it != list.end();) {
+			CargoPacket *cp = *list_it;
+			uint hash = cp->source_xy ^ cp->source_id * 31 ^ cp->source_type * 7 ^ cp->days_in_transit / COMPACT_DAYS_IN_TRANSIT * 97;
+			CargoPacket *&candidate = candidates[hash % COMPACT_CANDIDATES];
+
+			if (candidate == nullptr || !StationCargoList::AreCompactable(candidate, cp)) {
+				candidate = cp;
+				++list_it;
+				continue;
+			}
+
+			uint old_days = candidate->days_in_transit * candidate->count + cp->days_in_transit * cp->count;
+			uint total = candidate->count + cp->count;
+			candidate->days_in_transit = (old_days + total / 2) / total;
+			this->cargo_days_in_transit += candidate->days_in_transit * total - old_days;
+			candidate->Merge(cp);
+			list_it = list.erase(list_it);
+		}
+	}
+}
+
 /**
  * Shifts cargo from the front of the packet list for a specific station and
  * applies some action to it.
@@ -452,6 +452,10 @@ protected:
 
 	uint reserved_count; ///< Amount of cargo being reserved for loading.
 
+	static const uint MERGE_DEPTH = 16;             ///< Number of most recent packets for the same next hop an appended packet may be merged with.
+	static const uint COMPACT_DAYS_IN_TRANSIT = 4;  ///< Packets with the same days in transit divided by this can be compacted.
+	static const uint COMPACT_CANDIDATES = 64;      ///< Number of packets to remember as candidates for compacting into.
+
 public:
 	/** The super class ought to know what it's doing. */
 	friend class CargoList<StationCargoList, StationCargoPacketMap>;
@@ -475,6 +479,7 @@ public:
 	uint ShiftCargo(Taction action, StationIDStack next, bool include_invalid);
 
 	void Append(CargoPacket *cp, StationID next);
+	void Compact();
 
 	/**
 	 * Check for cargo headed for a specific station.
@@ -551,6 +556,22 @@ public:
 				cp1->source_type     == cp2->source_type &&
 				cp1->source_id       == cp2->source_id;
 	}
+
+	/**
+	 * Can two CargoPackets waiting at a station be compacted into one?
+	 * Unlike for merging, their days in transit only have to be similar.
+	 * @param cp1 First CargoPacket.
+	 * @param cp2 Second CargoPacket.
+	 * @return True if they can be compacted.
+	 */
+	static bool AreCompactable(const CargoPacket *cp1, const CargoPacket *cp2)
+	{
+		return cp1->source_xy    == cp2->source_xy &&
+				cp1->days_in_transit / COMPACT_DAYS_IN_TRANSIT == cp2->days_in_transit / COMPACT_DAYS_IN_TRANSIT &&
+				cp1->source_type     == cp2->source_type &&
+				cp1->source_id       == cp2->source_id &&
+				cp1->count + cp2->count <= CargoPacket::MAX_COUNT;
+	}
 };
 
 #endif /* CARGOPACKET_H */
@@ -309,6 +309,44 @@ static void TileLoop_Clear(TileIndex tile)
 	MarkTileDirtyByTile(tile);
 }
 
+/**
+ * Tile loop of clear tiles for when it solely involves the tile itself; that is
+ * for grass that is still growing and for ground that stays as it is.
+ * @param tile The tile to run the tile loop for.
+ * @return Whether the tile loop has been run.
+ * @see TileLoopLocalProc
+ */
+static bool TileLoopLocal_Clear(TileIndex tile)
+{
+	if (_game_mode == GM_EDITOR || HasGrfMiscBit(GMB_AMBIENT_SOUND_CALLBACK)) return false;
+	if (_settings_game.construction.freeform_edges && DistanceFromEdge(tile) == 1) return false;
+
+	switch (_settings_game.game_creation.landscape) {
+		case LT_TROPIC:
+			/* Desert depends on the tiles around it. */
+			if (GetTropicZone(tile) == TROPICZONE_DESERT || IsClearGround(tile, CLEAR_DESERT)) return false;
+			break;
+
+		case LT_ARCTIC:
+			if (IsSnowTile(tile) || GetTileZ(tile) + 1 >= GetSnowLine()) return false;
+			break;
+	}
+
+	switch (GetClearGround(tile)) {
+		case CLEAR_GRASS:
+			if (GetClearDensity(tile) == 3) return true;
+			if (GetClearCounter(tile) == 7) return false;
+			AddClearCounter(tile, 1);
+			return true;
+
+		case CLEAR_FIELDS:
+			return false;
+
+		default:
+			return true;
+	}
+}
+
 void GenerateClearTile()
 {
 	uint i, gi;
@@ -398,4 +436,5 @@ extern const TileTypeProcs _tile_type_clear_procs = {
 	nullptr,                     ///< vehicle_enter_tile_proc
 	GetFoundation_Clear,      ///< get_foundation_proc
 	TerraformTile_Clear,      ///< terraform_tile_proc
+	TileLoopLocal_Clear,      ///< tile_loop_local_proc
 };
@@ -22,6 +22,7 @@
 #include "company_func.h"
 #include "company_base.h"
 #include "signal_func.h"
+#include "pbs.h"
 #include "core/backup_type.hpp"
 #include "object_base.h"
 
@@ -763,6 +764,9 @@ CommandCost DoCommandPInternal(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd,
 	/* update signals if needed */
 	UpdateSignalsInBuffer();
 
+	/* The command may have changed the track layout or signals, so let stuck trains look for a path again. */
+	WakeAllTrainsWaitingForPath();
+
 	return_dcpi(res2);
 }
 #undef return_dcpi
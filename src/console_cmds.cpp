@@ -2071,6 +2071,19 @@ DEF_CONSOLE_CMD(ConFramerateWindow)
 	return true;
 }
 
+DEF_CONSOLE_CMD(ConVehicleHash)
+{
+	extern void ConPrintVehicleHashStats(); // vehicle.cpp
+
+	if (argc == 0) {
+		IConsoleHelp("Show the lengths of the chains of the vehicle position hashes");
+		return true;
+	}
+
+	ConPrintVehicleHashStats();
+	return true;
+}
+
 /*******************************
  * console command registration
  *******************************/
@@ -2203,6 +2216,7 @@ void IConsoleStdLibRegister()
 #endif
 	IConsoleCmdRegister("fps",     ConFramerate);
 	IConsoleCmdRegister("fps_wnd", ConFramerateWindow);
+	IConsoleCmdRegister("vehicle_hash", ConVehicleHash);
 
 	/* NewGRF development stuff */
 	IConsoleCmdRegister("reload_newgrfs",  ConNewGRFReload, ConHookNewGRFDeveloperTool);
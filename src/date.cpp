@@ -27,6 +27,7 @@ Month     _cur_month;  ///< Current month (0..11)
 Date      _date;       ///< Current date in days (day counter)
 DateFract _date_fract; ///< Fractional part of the day.
 uint16 _tick_counter;  ///< Ever incrementing (and sometimes wrapping) tick counter for setting off various events
+bool _new_month_pending; ///< Whether the monthly work spread over the first day of the month still has to be finished.
 
 int32 _old_ending_year_slv_105; ///< Old ending year for savegames before SLV_105
 
@@ -166,8 +167,9 @@ extern void IndustryDailyLoop();
 
 extern void CompaniesMonthlyLoop();
 extern void EnginesMonthlyLoop();
-extern void TownsMonthlyLoop();
-extern void IndustryMonthlyLoop();
+extern void TownsMonthlyLoop(uint tick);
+extern void IndustryMonthlyLoop(uint tick);
+extern void IndustryBuilderMonthlyLoop();
 extern void StationMonthlyLoop();
 extern void SubsidyMonthlyLoop();
 
@@ -221,6 +223,29 @@ static void OnNewYear()
 	if (_settings_client.gui.auto_euro) CheckSwitchToEuro();
 }
 
+/**
+ * Runs the parts of the monthly procedures that are spread over the ticks of
+ * the first day of the month, so not all towns and industries are handled on
+ * the same tick. The first of those ticks is run by OnNewMonth. Whether the
+ * spread is still going on is saved, so a game that is started or loaded
+ * halfway the first day does not redo the work of that month.
+ */
+static void OnNewMonthTick()
+{
+	if (!_new_month_pending) return;
+
+	TownsMonthlyLoop(_date_fract);
+	IndustryMonthlyLoop(_date_fract);
+
+	if (_date_fract != DAY_TICKS - 1) return;
+
+	/* These need the statistics of last month of all towns and industries. */
+	_new_month_pending = false;
+	IndustryBuilderMonthlyLoop();
+	SubsidyMonthlyLoop();
+	StationMonthlyLoop();
+}
+
 /**
  * Runs various procedures that have to be done monthly
  */
@@ -234,11 +259,10 @@ static void OnNewMonth()
 	SetWindowClassesDirty(WC_CHEATS);
 	CompaniesMonthlyLoop();
 	EnginesMonthlyLoop();
-	TownsMonthlyLoop();
-	IndustryMonthlyLoop();
-	SubsidyMonthlyLoop();
-	StationMonthlyLoop();
 	if (_network_server) NetworkServerMonthlyLoop();
+
+	_new_month_pending = true;
+	OnNewMonthTick();
 }
 
 /**
@@ -274,7 +298,10 @@ void IncreaseDate()
 	if (_game_mode == GM_MENU) return;
 
 	_date_fract++;
-	if (_date_fract < DAY_TICKS) return;
+	if (_date_fract < DAY_TICKS) {
+		OnNewMonthTick();
+		return;
+	}
 	_date_fract = 0;
 
 	/* increase day counter */
@@ -16,6 +16,7 @@ extern Year      _cur_year;
 extern Month     _cur_month;
 extern Date      _date;
 extern DateFract _date_fract;
+extern bool _new_month_pending;
 extern uint16 _tick_counter;
 
 void SetDate(Date date, DateFract fract);
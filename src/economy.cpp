@@ -540,6 +540,8 @@ void ChangeOwnershipOfCompanyItems(Owner old_owner, Owner new_owner)
 	cur_company.Restore();
 
 	MarkWholeScreenDirty();
+	/* The smallmap caches the colours of the tiles, so the old owner would stay visible. */
+	InvalidateWindowClassesData(WC_SMALLMAP, 3);
 }
 
 /**
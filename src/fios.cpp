@@ -19,6 +19,9 @@
 #include "string_func.h"
 #include "tar_type.h"
 #include <sys/stat.h>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 #ifndef _WIN32
 # include <unistd.h>
@@ -260,6 +263,63 @@ bool FiosDelete(const char *name)
 
 typedef FiosType fios_getlist_callback_proc(SaveLoadOperation fop, const char *filename, const char *ext, char *title, const char *last);
 
+/**
+ * What the callback of a FiosFileScanner found out about a file.
+ * The callback may have to open the file (or its .title file) to determine
+ * the title, so this is remembered for as long as the file does not change.
+ * Changes to only the .title file are thus not noticed until the file changes.
+ */
+struct FiosFileInfo {
+	uint64 mtime;                              ///< Modification time of the file.
+	uint64 size;                               ///< Size of the file in bytes.
+	fios_getlist_callback_proc *callback_proc; ///< The callback that determined the type and title.
+	SaveLoadOperation fop;                     ///< The purpose the callback was called for.
+	FiosType type;                             ///< Type of the file, as returned by the callback.
+	char title[64];                            ///< Title of the file, as returned by the callback.
+};
+
+/** Information about the files found so far, by full path of the file. */
+static std::unordered_map<std::string, FiosFileInfo> _fios_file_info;
+
+/**
+ * Get the modification time and size of a file.
+ * @param filename The full path to the file.
+ * @param[out] mtime The modification time in seconds since 01/01/1970.
+ * @param[out] size The size of the file in bytes.
+ * @return Whether the information could be determined.
+ */
+static bool FiosGetFileStat(const char *filename, uint64 *mtime, uint64 *size)
+{
+#ifdef _WIN32
+	// Retrieve the file modified date using GetFileTime rather than stat to work around an obscure MSVC bug that affects Windows XP
+	HANDLE fh = CreateFile(OTTD2FS(filename), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+	if (fh == INVALID_HANDLE_VALUE) return false;
+
+	FILETIME ft;
+	LARGE_INTEGER file_size;
+	bool success = GetFileTime(fh, nullptr, nullptr, &ft) != 0 && GetFileSizeEx(fh, &file_size) != 0;
+	if (success) {
+		ULARGE_INTEGER ft_int64;
+		ft_int64.HighPart = ft.dwHighDateTime;
+		ft_int64.LowPart = ft.dwLowDateTime;
+
+		// Convert from hectonanoseconds since 01/01/1601 to seconds since 01/01/1970
+		*mtime = ft_int64.QuadPart / 10000000ULL - 11644473600ULL;
+		*size = file_size.QuadPart;
+	}
+
+	CloseHandle(fh);
+	return success;
+#else
+	struct stat sb;
+	if (stat(filename, &sb) != 0) return false;
+
+	*mtime = sb.st_mtime;
+	*size = sb.st_size;
+	return true;
+#endif
+}
+
 /**
  * Scanner to scan for a particular type of FIOS file.
  */
@@ -267,6 +327,7 @@ class FiosFileScanner : public FileScanner {
 	SaveLoadOperation fop;   ///< The kind of file we are looking for.
 	fios_getlist_callback_proc *callback_proc; ///< Callback to check whether the file may be added
 	FileList &file_list;     ///< Destination of the found files.
+	std::unordered_set<std::string> added; ///< Full paths of the files added to #file_list.
 public:
 	/**
 	 * Create the scanner
@@ -292,51 +353,33 @@ bool FiosFileScanner::AddFile(const char *filename, size_t basepath_length, cons
 	const char *ext = strrchr(filename, '.');
 	if (ext == nullptr) return false;
 
-	char fios_title[64];
-	fios_title[0] = '\0'; // reset the title;
-
-	FiosType type = this->callback_proc(this->fop, filename, ext, fios_title, lastof(fios_title));
-	if (type == FIOS_TYPE_INVALID) return false;
-
-	for (const FiosItem *fios = file_list.Begin(); fios != file_list.End(); fios++) {
-		if (strcmp(fios->name, filename) == 0) return false;
+	/* Files inside tars can't be stat-ed; always ask the callback about those. */
+	uint64 mtime, size;
+	bool has_stat = tar_filename == nullptr && FiosGetFileStat(filename, &mtime, &size);
+	if (!has_stat) mtime = size = 0;
+
+	FiosFileInfo uncached;
+	FiosFileInfo *info = has_stat ? &_fios_file_info[filename] : &uncached;
+	if (!has_stat || info->mtime != mtime || info->size != size || info->callback_proc != this->callback_proc || info->fop != this->fop) {
+		info->mtime = mtime;
+		info->size = size;
+		info->callback_proc = this->callback_proc;
+		info->fop = this->fop;
+		info->title[0] = '\0'; // reset the title;
+		info->type = this->callback_proc(this->fop, filename, ext, info->title, lastof(info->title));
 	}
+	if (info->type == FIOS_TYPE_INVALID) return false;
 
-	FiosItem *fios = file_list.Append();
-#ifdef _WIN32
-	// Retrieve the file modified date using GetFileTime rather than stat to work around an obscure MSVC bug that affects Windows XP
-	HANDLE fh = CreateFile(OTTD2FS(filename), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
-
-	if (fh != INVALID_HANDLE_VALUE) {
-		FILETIME ft;
-		ULARGE_INTEGER ft_int64;
-
-		if (GetFileTime(fh, nullptr, nullptr, &ft) != 0) {
-			ft_int64.HighPart = ft.dwHighDateTime;
-			ft_int64.LowPart = ft.dwLowDateTime;
+	if (!this->added.insert(filename).second) return false;
 
-			// Convert from hectonanoseconds since 01/01/1601 to seconds since 01/01/1970
-			fios->mtime = ft_int64.QuadPart / 10000000ULL - 11644473600ULL;
-		} else {
-			fios->mtime = 0;
-		}
-
-		CloseHandle(fh);
-#else
-	struct stat sb;
-	if (stat(filename, &sb) == 0) {
-		fios->mtime = sb.st_mtime;
-#endif
-	} else {
-		fios->mtime = 0;
-	}
-
-	fios->type = type;
+	FiosItem *fios = file_list.Append();
+	fios->mtime = mtime;
+	fios->type = info->type;
 	strecpy(fios->name, filename, lastof(fios->name));
 
 	/* If the file doesn't have a title, use its filename */
-	const char *t = fios_title;
-	if (StrEmpty(fios_title)) {
+	const char *t = info->title;
+	if (StrEmpty(info->title)) {
 		t = strrchr(filename, PATHSEPCHAR);
 		t = (t == nullptr) ? filename : (t + 1);
 	}
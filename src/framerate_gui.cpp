@@ -23,6 +23,9 @@
 #include "ai/ai_instance.hpp"
 #include "game/game.hpp"
 #include "game/game_instance.hpp"
+#include "newgrf_config.h"
+#include "newgrf_profiling.h"
+#include <algorithm>
 
 #include "widgets/framerate_widget.h"
 #include "safeguards.h"
@@ -60,13 +63,20 @@ namespace {
 		/** Start time for current accumulation cycle */
 		TimingMeasurement acc_timestamp;
 
+		/** Whether every measurement is also kept in \c recorded */
+		bool recording;
+		/** Whether the current accumulation cycle began while recording */
+		bool acc_recording;
+		/** All measurements taken while recording, for benchmark reports */
+		std::vector<TimingMeasurement> recorded;
+
 		/**
 		 * Initialize a data element with an expected collection rate
 		 * @param expected_rate
 		 * Expected number of cycles per second of the performance element. Use 1 if unknown or not relevant.
 		 * The rate is used for highlighting slow-running elements in the GUI.
 		 */
-		explicit PerformanceData(double expected_rate) : expected_rate(expected_rate), next_index(0), prev_index(0), num_valid(0) { }
+		explicit PerformanceData(double expected_rate) : expected_rate(expected_rate), next_index(0), prev_index(0), num_valid(0), recording(false), acc_recording(false) { }
 
 		/** Collect a complete measurement, given start and ending times for a processing block */
 		void Add(TimingMeasurement start_time, TimingMeasurement end_time)
@@ -77,6 +87,8 @@ namespace {
 			this->next_index += 1;
 			if (this->next_index >= NUM_FRAMERATE_POINTS) this->next_index = 0;
 			this->num_valid = min(NUM_FRAMERATE_POINTS, this->num_valid + 1);
+
+			if (this->recording) this->recorded.push_back(end_time - start_time);
 		}
 
 		/** Begin an accumulation of multiple measurements into a single value, from a given start time */
@@ -89,8 +101,11 @@ namespace {
 			if (this->next_index >= NUM_FRAMERATE_POINTS) this->next_index = 0;
 			this->num_valid = min(NUM_FRAMERATE_POINTS, this->num_valid + 1);
 
+			if (this->acc_recording) this->recorded.push_back(this->acc_duration);
+
 			this->acc_duration = 0;
 			this->acc_timestamp = start_time;
+			this->acc_recording = this->recording;
 		}
 
 		/** Accumulate a period onto the current measurement */
@@ -303,6 +318,89 @@ void PerformanceAccumulator::Reset(PerformanceElement elem)
 }
 
 
+/**
+ * Start keeping every measurement taken, for a benchmark report.
+ * Sound mixing is left out, as it is measured on a thread of its own.
+ */
+void StartPerformanceRecording()
+{
+	for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+		PerformanceData &pf = _pf_data[e];
+		pf.recorded.clear();
+		pf.recording = e != PFE_SOUND;
+		pf.acc_recording = false;
+	}
+}
+
+/**
+ * Stop keeping measurements.
+ * Accumulation cycles that are still running are recorded as they are now.
+ */
+void StopPerformanceRecording()
+{
+	for (PerformanceData &pf : _pf_data) {
+		if (pf.acc_recording) pf.recorded.push_back(pf.acc_duration);
+		pf.recording = false;
+		pf.acc_recording = false;
+	}
+}
+
+/**
+ * Write the statistics of the recorded measurements as the members of a JSON object.
+ * Elements without any recorded measurement are left out.
+ * @param f The file to write to.
+ */
+void WritePerformanceRecording(FILE *f)
+{
+	static const char * const RECORDING_NAMES[] = {
+		"gameloop",
+		"gl_economy",
+		"gl_trains",
+		"gl_roadvehs",
+		"gl_ships",
+		"gl_aircraft",
+		"gl_landscape",
+		"gl_linkgraph",
+		"drawing",
+		"drawworld",
+		"video",
+		"sound",
+		"allscripts",
+		"gamescript",
+	};
+	assert_compile(lengthof(RECORDING_NAMES) == PFE_AI0);
+
+	auto to_ms = [](TimingMeasurement t) { return (double)t * 1000 / TIMESTAMP_PRECISION; };
+
+	bool first = true;
+	for (PerformanceElement e = PFE_FIRST; e < PFE_MAX; e++) {
+		std::vector<TimingMeasurement> &recorded = _pf_data[e].recorded;
+		if (recorded.empty()) continue;
+
+		std::sort(recorded.begin(), recorded.end());
+		TimingMeasurement total = 0;
+		for (TimingMeasurement d : recorded) total += d;
+		size_t count = recorded.size();
+
+		char name[16];
+		if (e < PFE_AI0) {
+			strecpy(name, RECORDING_NAMES[e], lastof(name));
+		} else {
+			seprintf(name, lastof(name), "ai%d", e - PFE_AI0 + 1);
+		}
+
+		/* Percentiles use the nearest rank. */
+		fprintf(f, "%s\n\t\t\"%s\": { \"samples\": " PRINTF_SIZE ", \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f }",
+			first ? "" : ",", name, count,
+			to_ms(total) / count,
+			to_ms(recorded[(count + 1) / 2 - 1]),
+			to_ms(recorded[(count * 99 + 99) / 100 - 1]),
+			to_ms(recorded[count - 1]));
+		first = false;
+	}
+}
+
+
 void ShowFrametimeGraphWindow(PerformanceElement elem);
 
 
@@ -371,6 +469,9 @@ static const NWidgetPart _framerate_window_widgets[] = {
 					EndContainer(),
 				EndContainer(),
 				NWidget(WWT_TEXT, COLOUR_GREY, WID_FRW_INFO_DATA_POINTS), SetDataTip(STR_FRAMERATE_DATA_POINTS, 0x0),
+				NWidget(NWID_SELECTION, INVALID_COLOUR, WID_FRW_SEL_NEWGRF),
+					NWidget(WWT_EMPTY, COLOUR_GREY, WID_FRW_NEWGRF_COSTS), SetFill(1, 0),
+				EndContainer(),
 			EndContainer(),
 		EndContainer(),
 		NWidget(NWID_VERTICAL),
@@ -383,6 +484,7 @@ static const NWidgetPart _framerate_window_widgets[] = {
 struct FramerateWindow : Window {
 	bool small;
 	bool showing_memory;
+	bool showing_newgrf;
 	GUITimer next_update;
 	int num_active;
 	int num_displayed;
@@ -422,14 +524,25 @@ struct FramerateWindow : Window {
 	CachedDecimal times_shortterm[PFE_MAX]; ///< cached short term average times
 	CachedDecimal times_longterm[PFE_MAX];  ///< cached long term average times
 
+	/** Time spent on one category of features of a NewGRF. */
+	struct NewGRFCostLine {
+		uint32 grfid;                 ///< ID of the NewGRF.
+		NewGRFCostCategory category;  ///< Category of the features.
+		uint64 average;               ///< Average time per tick, in nanoseconds.
+		CachedDecimal time;           ///< Cached average time per tick.
+	};
+	std::vector<NewGRFCostLine> newgrf_costs; ///< cached most expensive NewGRFs, most expensive first
+
 	static const int VSPACING = 3;          ///< space between column heading and values
 	static const int MIN_ELEMENTS = 5;      ///< smallest number of elements to display
+	static const uint NUM_NEWGRF_COSTS = 5; ///< number of most expensive NewGRFs to display
 
 	FramerateWindow(WindowDesc *desc, WindowNumber number) : Window(desc)
 	{
 		this->InitNested(number);
 		this->small = this->IsShaded();
 		this->showing_memory = true;
+		this->showing_newgrf = true;
 		this->UpdateData();
 		this->num_displayed = this->num_active;
 		this->next_update.SetInterval(100);
@@ -482,6 +595,25 @@ struct FramerateWindow : Window {
 			this->showing_memory = have_script;
 		}
 
+		this->newgrf_costs.clear();
+		for (const auto &it : _newgrf_costs) {
+			for (NewGRFCostCategory c = NGCC_BEGIN; c < NGCC_END; c++) {
+				if (it.second.average[c] != 0) this->newgrf_costs.push_back({ it.first->grfid, c, it.second.average[c], {} });
+			}
+		}
+		auto last = this->newgrf_costs.begin() + min<size_t>(NUM_NEWGRF_COSTS, this->newgrf_costs.size());
+		std::partial_sort(this->newgrf_costs.begin(), last, this->newgrf_costs.end(), [](const NewGRFCostLine &a, const NewGRFCostLine &b) { return a.average > b.average; });
+		this->newgrf_costs.erase(last, this->newgrf_costs.end());
+		for (NewGRFCostLine &line : this->newgrf_costs) line.time.SetTime(line.average / 1000000.0, MILLISECONDS_PER_TICK);
+
+		bool have_newgrf = !this->newgrf_costs.empty();
+		if (this->showing_newgrf != have_newgrf) {
+			NWidgetStacked *plane = this->GetWidget<NWidgetStacked>(WID_FRW_SEL_NEWGRF);
+			plane->SetDisplayedPlane(have_newgrf ? 0 : SZSP_HORIZONTAL);
+			this->showing_newgrf = have_newgrf;
+			this->ReInit();
+		}
+
 		if (new_active != this->num_active) {
 			this->num_active = new_active;
 			Scrollbar *sb = this->GetScrollbar(WID_FRW_SCROLLBAR);
@@ -573,6 +705,11 @@ struct FramerateWindow : Window {
 				resize->height = FONT_HEIGHT_NORMAL;
 				break;
 			}
+
+			case WID_FRW_NEWGRF_COSTS:
+				*size = GetStringBoundingBox(STR_FRAMERATE_NEWGRF_COSTS);
+				size->height = FONT_HEIGHT_NORMAL * (1 + NUM_NEWGRF_COSTS) + VSPACING;
+				break;
 		}
 	}
 
@@ -630,6 +767,27 @@ struct FramerateWindow : Window {
 		}
 	}
 
+	/** Render the most expensive NewGRFs with the time spent on them */
+	void DrawNewGRFCosts(const Rect &r) const
+	{
+		int y = r.top;
+		DrawString(r.left, r.right, y, STR_FRAMERATE_NEWGRF_COSTS, TC_FROMSTRING, SA_LEFT);
+		y += FONT_HEIGHT_NORMAL + VSPACING;
+
+		SetDParam(0, 999999);
+		SetDParam(1, 2);
+		int value_width = GetStringBoundingBox(STR_FRAMERATE_MS_GOOD).width;
+		for (const NewGRFCostLine &line : this->newgrf_costs) {
+			const GRFConfig *config = GetGRFConfig(line.grfid);
+			SetDParamStr(0, config != nullptr ? config->GetName() : "");
+			SetDParam(1, STR_FRAMERATE_NEWGRF_VEHICLES + line.category);
+			DrawString(r.left, r.right - value_width, y, STR_FRAMERATE_NEWGRF_COST_NAME, TC_FROMSTRING, SA_LEFT);
+			line.time.InsertDParams(0);
+			DrawString(r.left, r.right, y, line.time.strid, TC_FROMSTRING, SA_RIGHT);
+			y += FONT_HEIGHT_NORMAL;
+		}
+	}
+
 	void DrawWidget(const Rect &r, int widget) const override
 	{
 		switch (widget) {
@@ -669,6 +827,9 @@ struct FramerateWindow : Window {
 			case WID_FRW_ALLOCSIZE:
 				DrawElementAllocationsColumn(r);
 				break;
+			case WID_FRW_NEWGRF_COSTS:
+				DrawNewGRFCosts(r);
+				break;
 		}
 	}
 
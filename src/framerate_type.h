@@ -19,6 +19,7 @@
  *
  * @par
  * Third is adding strings for the new element. There is an array in #ConPrintFramerate with strings used for the console command.
+ * The array in #WritePerformanceRecording holds the names used in benchmark reports.
  * Additionally, there are two sets of strings in \c english.txt for two GUI uses, also in the #PerformanceElement order.
  * Search for \c STR_FRAMERATE_GAMELOOP and \c STR_FRAMETIME_CAPTION_GAMELOOP in \c english.txt to find those.
  *
@@ -122,4 +123,8 @@ public:
 
 void ShowFramerateWindow();
 
+void StartPerformanceRecording();
+void StopPerformanceRecording();
+void WritePerformanceRecording(FILE *f);
+
 #endif /* FRAMERATE_TYPE_H */
@@ -30,8 +30,13 @@
 #include "safeguards.h"
 
 
+/** Maximum number of lines in the linecache. */
+static const size_t MAX_LINECACHE_SIZE = 4096;
+
 /** Cache of ParagraphLayout lines. */
 Layouter::LineCache *Layouter::linecache;
+/** Index into the cache of ParagraphLayout lines. */
+Layouter::LineCacheIndex *Layouter::linecache_index;
 
 /** Cache of Font instances. */
 Layouter::FontColourMap Layouter::fonts[FS_END];
@@ -873,9 +878,34 @@ void Layouter::ResetFontCache(FontSize size)
 #endif
 }
 
+/**
+ * Compute the hash of a key of the linecache.
+ * Of the colour stack only the size is hashed; the full stack is compared on lookup.
+ * @param str Source string of the line (including colour and font size codes).
+ * @param len Length of \a str in bytes (no termination).
+ * @param state State of the font at the beginning of the line.
+ * @return The hash.
+ */
+/* static */ size_t Layouter::HashLineCacheKey(const char *str, size_t len, const FontState &state)
+{
+	/* FNV-1a */
+	uint32 hash = 2166136261U;
+	auto add = [&hash](uint32 value) {
+		hash ^= value;
+		hash *= 16777619U;
+	};
+
+	add(state.fontsize);
+	add(state.cur_colour);
+	add((uint32)state.colour_stack.size());
+	for (size_t i = 0; i < len; i++) add((byte)str[i]);
+	return hash;
+}
+
 /**
  * Get reference to cache item.
  * If the item does not exist yet, it is default constructed.
+ * The returned item stays valid till the next ResetLineCache or ReduceLineCache.
  * @param str Source string of the line (including colour and font size codes).
  * @param len Length of \a str in bytes (no termination).
  * @param state State of the font at the beginning of the line.
@@ -886,12 +916,31 @@ Layouter::LineCacheItem &Layouter::GetCachedParagraphLayout(const char *str, siz
 	if (linecache == nullptr) {
 		/* Create linecache on first access to avoid trouble with initialisation order of static variables. */
 		linecache = new LineCache();
+		linecache_index = new LineCacheIndex();
+	}
+
+	size_t hash = HashLineCacheKey(str, len, state);
+
+	auto range = linecache_index->equal_range(hash);
+	for (auto it = range.first; it != range.second; ++it) {
+		LineCache::iterator entry = it->second;
+		const LineCacheKey &key = entry->key;
+		if (key.state_before.fontsize != state.fontsize || key.state_before.cur_colour != state.cur_colour) continue;
+		if (key.str.size() != len || memcmp(key.str.data(), str, len) != 0) continue;
+		if (key.state_before.colour_stack != state.colour_stack) continue;
+
+		/* Mark the line as most recently used. */
+		linecache->splice(linecache->begin(), *linecache, entry);
+		return entry->item;
 	}
 
-	LineCacheKey key;
-	key.state_before = state;
-	key.str.assign(str, len);
-	return (*linecache)[key];
+	linecache->emplace_front();
+	LineCacheEntry &entry = linecache->front();
+	entry.hash = hash;
+	entry.key.state_before = state;
+	entry.key.str.assign(str, len);
+	linecache_index->emplace(hash, linecache->begin());
+	return entry.item;
 }
 
 /**
@@ -899,16 +948,31 @@ Layouter::LineCacheItem &Layouter::GetCachedParagraphLayout(const char *str, siz
  */
 void Layouter::ResetLineCache()
 {
-	if (linecache != nullptr) linecache->clear();
+	if (linecache != nullptr) {
+		linecache_index->clear();
+		linecache->clear();
+	}
 }
 
 /**
  * Reduce the size of linecache if necessary to prevent infinite growth.
+ * The least recently used lines are removed first.
  */
 void Layouter::ReduceLineCache()
 {
-	if (linecache != nullptr) {
-		/* TODO LRU cache would be fancy, but not exactly necessary */
-		if (linecache->size() > 4096) ResetLineCache();
+	if (linecache == nullptr) return;
+
+	while (linecache->size() > MAX_LINECACHE_SIZE) {
+		LineCache::iterator entry = std::prev(linecache->end());
+
+		auto range = linecache_index->equal_range(entry->hash);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == entry) {
+				linecache_index->erase(it);
+				break;
+			}
+		}
+
+		linecache->erase(entry);
 	}
 }
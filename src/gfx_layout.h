@@ -14,9 +14,10 @@
 #include "gfx_func.h"
 #include "core/smallmap_type.hpp"
 
-#include <map>
+#include <list>
 #include <string>
 #include <stack>
+#include <unordered_map>
 #include <vector>
 
 #ifdef WITH_ICU_LX
@@ -155,15 +156,6 @@ class Layouter : public std::vector<std::unique_ptr<const ParagraphLayouter::Lin
 	struct LineCacheKey {
 		FontState state_before;  ///< Font state at the beginning of the line.
 		std::string str;         ///< Source string of the line (including colour and font size codes).
-
-		/** Comparison operator for std::map */
-		bool operator<(const LineCacheKey &other) const
-		{
-			if (this->state_before.fontsize != other.state_before.fontsize) return this->state_before.fontsize < other.state_before.fontsize;
-			if (this->state_before.cur_colour != other.state_before.cur_colour) return this->state_before.cur_colour < other.state_before.cur_colour;
-			if (this->state_before.colour_stack != other.state_before.colour_stack) return this->state_before.colour_stack < other.state_before.colour_stack;
-			return this->str < other.str;
-		}
 	};
 public:
 	/** Item in the linecache */
@@ -179,9 +171,21 @@ public:
 		~LineCacheItem() { delete layout; free(buffer); }
 	};
 private:
-	typedef std::map<LineCacheKey, LineCacheItem> LineCache;
+	/** Entry of the linecache. */
+	struct LineCacheEntry {
+		size_t hash;               ///< Hash of the key, see HashLineCacheKey.
+		LineCacheKey key;          ///< Key of the entry.
+		LineCacheItem item;        ///< The cached line.
+	};
+
+	/** The linecache; ordered by last use, the most recently used entry first. Entries never move in memory. */
+	typedef std::list<LineCacheEntry> LineCache;
+	/** Index into the linecache by hash of the key. */
+	typedef std::unordered_multimap<size_t, LineCache::iterator> LineCacheIndex;
 	static LineCache *linecache;
+	static LineCacheIndex *linecache_index;
 
+	static size_t HashLineCacheKey(const char *str, size_t len, const FontState &state);
 	static LineCacheItem &GetCachedParagraphLayout(const char *str, size_t len, const FontState &state);
 
 	typedef SmallMap<TextColour, Font *> FontColourMap;
@@ -2839,13 +2839,20 @@ void IndustryDailyLoop()
 	InvalidateWindowData(WC_INDUSTRY_DIRECTORY, 0, IDIWD_PRODUCTION_CHANGE);
 }
 
-void IndustryMonthlyLoop()
+/**
+ * Monthly loop for industries. To prevent a lag spike at the start of the
+ * month, every industry is handled on the tick of the first day of the month
+ * that matches its index.
+ * @param tick The tick of the first day of the month.
+ */
+void IndustryMonthlyLoop(uint tick)
 {
 	Backup<CompanyID> cur_company(_current_company, OWNER_NONE, FILE_LINE);
 
-	_industry_builder.MonthlyLoop();
+	for (size_t index = tick; index < Industry::GetPoolSize(); index += DAY_TICKS) {
+		Industry *i = Industry::GetIfValid(index);
+		if (i == nullptr) continue;
 
-	for (Industry *i : Industry::Iterate()) {
 		UpdateIndustryStatistics(i);
 		if (i->prod_level == PRODLEVEL_CLOSURE) {
 			delete i;
@@ -2858,7 +2865,18 @@ void IndustryMonthlyLoop()
 	cur_company.Restore();
 
 	/* production-change */
-	InvalidateWindowData(WC_INDUSTRY_DIRECTORY, 0, IDIWD_PRODUCTION_CHANGE);
+	if (tick == DAY_TICKS - 1) InvalidateWindowData(WC_INDUSTRY_DIRECTORY, 0, IDIWD_PRODUCTION_CHANGE);
+}
+
+/**
+ * Monthly loop for the building of new industries. It is run after the
+ * monthly loop of the last industries on the first day of the month.
+ */
+void IndustryBuilderMonthlyLoop()
+{
+	Backup<CompanyID> cur_company(_current_company, OWNER_NONE, FILE_LINE);
+	_industry_builder.MonthlyLoop();
+	cur_company.Restore();
 }
 
 
@@ -2994,6 +3012,7 @@ extern const TileTypeProcs _tile_type_industry_procs = {
 	nullptr,                        // vehicle_enter_tile_proc
 	GetFoundation_Industry,      // get_foundation_proc
 	TerraformTile_Industry,      // terraform_tile_proc
+	nullptr,                     // tile_loop_local_proc
 };
 
 bool IndustryCompare::operator() (const Industry *lhs, const Industry *rhs) const
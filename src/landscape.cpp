@@ -31,6 +31,7 @@
 #include "pathfinder/npf/aystar.h"
 #include "saveload/saveload.h"
 #include "framerate_type.h"
+#include "thread_pool.h"
 #include <list>
 #include <set>
 
@@ -795,6 +796,91 @@ CommandCost CmdClearArea(TileIndex tile, DoCommandFlag flags, uint32 p1, uint32
 
 TileIndex _cur_tileloop_tile;
 
+/** State of a tile of which the tile loop is run in parallel. */
+struct TileLoopState {
+	TileIndex tile;          ///< The tile.
+	bool local;              ///< Whether the tile loop solely involved the tile itself.
+	Tile before;             ///< The tile before its tile loop was run.
+	Tile after;              ///< The tile after its tile loop was run.
+	TileExtended before_ext; ///< The extended tile before its tile loop was run.
+	TileExtended after_ext;  ///< The extended tile after its tile loop was run.
+};
+
+static const uint TILE_LOOP_PARALLEL_MIN_TILES = 1 << 12; ///< Minimum number of tiles per tick to run the tile loop in parallel.
+static const uint TILE_LOOP_TILES_PER_TASK = 1 << 10;     ///< Number of tiles of which the tile loop is run by a single task.
+
+static std::vector<TileLoopState> _tile_loop_states; ///< Tiles of which the tile loop is run this tick.
+
+/**
+ * Run the tile loop of a tile when it solely involves the tile itself, but
+ * keep the tile as it is; the new state is stored for later use instead.
+ * @param state The tile to run the tile loop for.
+ */
+static void RunTileLoopLocal(TileLoopState &state)
+{
+	TileLoopLocalProc *proc = _tile_type_procs[GetTileType(state.tile)]->tile_loop_local_proc;
+	state.local = false;
+	if (proc == nullptr) return;
+
+	Tile &t = _m[state.tile];
+	TileExtended &te = _me[state.tile];
+	state.before = t;
+	state.before_ext = te;
+	if (!proc(state.tile)) return;
+
+	state.local = true;
+	state.after = t;
+	state.after_ext = te;
+
+	/* Restore the tile, so the tile loops of other tiles that come before it still see
+	 * the old state. The type and height are never changed by the tile loop local
+	 * procs, but the height may be read by other threads, so do not write it back. */
+	t.m1 = state.before.m1;
+	t.m2 = state.before.m2;
+	t.m3 = state.before.m3;
+	t.m4 = state.before.m4;
+	t.m5 = state.before.m5;
+	te = state.before_ext;
+}
+
+/**
+ * Run the tile loop for a batch of tiles. Tiles of which the tile loop solely
+ * involves the tile itself are handled in parallel first. Then the tiles are
+ * handled in their original order; for those handled in parallel, the stored
+ * new state is used when the tile has not been changed since. That way the
+ * outcome is exactly the same as when running the tile loops one by one.
+ * @param count The number of tiles to run the tile loop for.
+ * @param tile The first tile.
+ * @param feedback The feedback term of the LFSR.
+ * @return The tile after the last tile of the batch.
+ */
+static TileIndex RunTileLoopParallel(uint count, TileIndex tile, uint32 feedback)
+{
+	static ThreadPool thread_pool("ottd:tileloop");
+
+	_tile_loop_states.resize(count);
+	for (TileLoopState &state : _tile_loop_states) {
+		state.tile = tile;
+		tile = (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+	}
+
+	thread_pool.Run(CeilDiv(count, TILE_LOOP_TILES_PER_TASK), [count](uint index) {
+		uint last = min((index + 1) * TILE_LOOP_TILES_PER_TASK, count);
+		for (uint i = index * TILE_LOOP_TILES_PER_TASK; i < last; i++) RunTileLoopLocal(_tile_loop_states[i]);
+	});
+
+	for (const TileLoopState &state : _tile_loop_states) {
+		if (state.local && memcmp(&_m[state.tile], &state.before, sizeof(Tile)) == 0 && memcmp(&_me[state.tile], &state.before_ext, sizeof(TileExtended)) == 0) {
+			_m[state.tile] = state.after;
+			_me[state.tile] = state.after_ext;
+		} else {
+			_tile_type_procs[GetTileType(state.tile)]->tile_loop_proc(state.tile);
+		}
+	}
+
+	return tile;
+}
+
 /**
  * Gradually iterate over all tiles on the map, calling their TileLoopProcs once every 256 ticks.
  */
@@ -827,11 +913,15 @@ void RunTileLoop()
 		count--;
 	}
 
-	while (count--) {
-		_tile_type_procs[GetTileType(tile)]->tile_loop_proc(tile);
+	if (count >= TILE_LOOP_PARALLEL_MIN_TILES) {
+		tile = RunTileLoopParallel(count, tile, feedback);
+	} else {
+		while (count--) {
+			_tile_type_procs[GetTileType(tile)]->tile_loop_proc(tile);
 
-		/* Get the next tile in sequence using a Galois LFSR. */
-		tile = (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+			/* Get the next tile in sequence using a Galois LFSR. */
+			tile = (tile >> 1) ^ (-(int32)(tile & 1) & feedback);
+		}
 	}
 
 	_cur_tileloop_tile = tile;
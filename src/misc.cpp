@@ -30,6 +30,7 @@
 #include "town_kdtree.h"
 #include "viewport_kdtree.h"
 #include "newgrf_profiling.h"
+#include "pbs.h"
 
 #include "safeguards.h"
 
@@ -74,11 +75,13 @@ void InitializeGame(uint size_x, uint size_y, bool reset_date, bool reset_settin
 
 	if (reset_date) {
 		SetDate(ConvertYMDToDate(_settings_game.game_creation.starting_year, 0, 1), 0);
+		_new_month_pending = false;
 		InitializeOldNames();
 	}
 
 	LinkGraphSchedule::Clear();
 	PoolBase::Clean(PT_NORMAL);
+	RebuildPathReservationWaits();
 
 	RebuildStationKdtree();
 	RebuildTownKdtree();
@@ -59,6 +59,7 @@ enum PacketAdminType {
 	ADMIN_PACKET_SERVER_GAMESCRIPT,      ///< The server gives the admin information from the GameScript in JSON.
 	ADMIN_PACKET_SERVER_RCON_END,        ///< The server indicates that the remote console command has completed.
 	ADMIN_PACKET_SERVER_PONG,            ///< The server replies to a ping request from the admin.
+	ADMIN_PACKET_SERVER_NEWGRF_COSTS,    ///< The server gives the admin the time spent on a NewGRF.
 
 	INVALID_ADMIN_PACKET = 0xFF,         ///< An invalid marker for admin packets.
 };
@@ -82,6 +83,7 @@ enum AdminUpdateType {
 	ADMIN_UPDATE_CMD_NAMES,       ///< The admin would like a list of all DoCommand names.
 	ADMIN_UPDATE_CMD_LOGGING,     ///< The admin would like to have DoCommand information.
 	ADMIN_UPDATE_GAMESCRIPT,      ///< The admin would like to have gamescript messages.
+	ADMIN_UPDATE_NEWGRF_COSTS,    ///< Updates about the time spent on NewGRFs.
 	ADMIN_UPDATE_END,             ///< Must ALWAYS be on the end of this list!! (period)
 };
 
@@ -477,6 +479,20 @@ protected:
 	 */
 	virtual NetworkRecvStatus Receive_SERVER_RCON_END(Packet *p);
 
+	/**
+	 * Estimated time spent resolving the callbacks and sprites of a NewGRF,
+	 * as a rolling average over roughly the last second of game ticks:
+	 * uint32  ID of the NewGRF.
+	 * uint32  Nanoseconds per tick spent on vehicles.
+	 * uint32  Nanoseconds per tick spent on stations, airports and airport tiles.
+	 * uint32  Nanoseconds per tick spent on houses.
+	 * uint32  Nanoseconds per tick spent on industries and industry tiles.
+	 * uint32  Nanoseconds per tick spent on all other features.
+	 * @param p The packet that was just received.
+	 * @return The state the network should have.
+	 */
+	virtual NetworkRecvStatus Receive_SERVER_NEWGRF_COSTS(Packet *p);
+
 	NetworkRecvStatus HandlePacket(Packet *p);
 public:
 	NetworkRecvStatus CloseConnection(bool error = true) override;
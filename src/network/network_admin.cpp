@@ -20,6 +20,7 @@
 #include "../map_func.h"
 #include "../rev.h"
 #include "../game/game.hpp"
+#include "../newgrf_profiling.h"
 
 #include "../safeguards.h"
 
@@ -52,6 +53,7 @@ static const AdminUpdateFrequency _admin_update_type_frequencies[] = {
 	ADMIN_FREQUENCY_POLL,                                                                                                                                  ///< ADMIN_UPDATE_CMD_NAMES
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_CMD_LOGGING
 	                       ADMIN_FREQUENCY_AUTOMATIC,                                                                                                      ///< ADMIN_UPDATE_GAMESCRIPT
+	ADMIN_FREQUENCY_POLL | ADMIN_FREQUENCY_DAILY | ADMIN_FREQUENCY_WEEKLY | ADMIN_FREQUENCY_MONTHLY | ADMIN_FREQUENCY_QUARTERLY | ADMIN_FREQUENCY_ANUALLY, ///< ADMIN_UPDATE_NEWGRF_COSTS
 };
 /** Sanity check. */
 assert_compile(lengthof(_admin_update_type_frequencies) == ADMIN_UPDATE_END);
@@ -457,6 +459,23 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::SendCompanyStats()
 	return NETWORK_RECV_STATUS_OKAY;
 }
 
+/** Send the estimated time spent on each NewGRF. */
+NetworkRecvStatus ServerNetworkAdminSocketHandler::SendNewGRFCosts()
+{
+	for (const auto &it : _newgrf_costs) {
+		Packet *p = new Packet(ADMIN_PACKET_SERVER_NEWGRF_COSTS);
+
+		p->Send_uint32(it.first->grfid);
+		for (NewGRFCostCategory c = NGCC_BEGIN; c < NGCC_END; c++) {
+			p->Send_uint32((uint32)min<uint64>(it.second.average[c], UINT32_MAX));
+		}
+
+		this->SendPacket(p);
+	}
+
+	return NETWORK_RECV_STATUS_OKAY;
+}
+
 /**
  * Send a chat message.
  * @param action The action associated with the message.
@@ -763,6 +782,11 @@ NetworkRecvStatus ServerNetworkAdminSocketHandler::Receive_ADMIN_POLL(Packet *p)
 			this->SendCompanyStats();
 			break;
 
+		case ADMIN_UPDATE_NEWGRF_COSTS:
+			/* The admin is requesting the time spent on NewGRFs. */
+			this->SendNewGRFCosts();
+			break;
+
 		case ADMIN_UPDATE_CMD_NAMES:
 			/* The admin is requesting the names of DoCommands. */
 			this->SendCmdNames();
@@ -1016,6 +1040,10 @@ void NetworkAdminUpdate(AdminUpdateFrequency freq)
 						as->SendCompanyStats();
 						break;
 
+					case ADMIN_UPDATE_NEWGRF_COSTS:
+						as->SendNewGRFCosts();
+						break;
+
 					default: NOT_REACHED();
 				}
 			}
@@ -34,6 +34,7 @@
 #include "newgrf_airporttiles.h"
 #include "newgrf_airport.h"
 #include "newgrf_object.h"
+#include "newgrf_profiling.h"
 #include "rev.h"
 #include "fios.h"
 #include "strings_func.h"
@@ -5112,6 +5113,8 @@ static void NewSpriteGroup(ByteReader *buf)
 				group->ranges = MallocT<DeterministicSpriteGroupRange>(group->num_ranges);
 				MemCpyT(group->ranges, &optimised.front(), group->num_ranges);
 			}
+
+			group->Compile();
 			break;
 		}
 
@@ -8643,6 +8646,7 @@ void ResetNewGRFData()
 	_grf_id_overrides.clear();
 
 	InitializeSoundPool();
+	ResetNewGRFCosts();
 	_spritegroup_pool.CleanPool();
 }
 
@@ -15,12 +15,18 @@
 #include "spritecache.h"
 
 #include <chrono>
+#include <thread>
 #include <time.h>
 
 
 std::vector<NewGRFProfiler> _newgrf_profilers;
 Date _newgrf_profile_end_date;
 
+thread_local uint _newgrf_cost_countdown = NEWGRF_COST_SAMPLE_INTERVAL; ///< Number of top level resolves of this thread till the next one is timed.
+std::map<const GRFFile *, NewGRFCost> _newgrf_costs; ///< Estimated time spent on each NewGRF; only used by the main thread.
+
+static const std::thread::id _newgrf_cost_thread = std::this_thread::get_id(); ///< The main thread, which keeps #_newgrf_costs.
+
 
 /**
  * Create profiler object and begin profiling session.
@@ -160,3 +166,74 @@ uint32 NewGRFProfiler::FinishAll()
 
 	return total_microseconds;
 }
+
+
+/**
+ * Get the category the time spent on a feature is attributed to.
+ * @param feature The feature being resolved for.
+ * @return The category of the feature.
+ */
+static NewGRFCostCategory GetNewGRFCostCategory(GrfSpecFeature feature)
+{
+	switch (feature) {
+		case GSF_TRAINS:
+		case GSF_ROADVEHICLES:
+		case GSF_SHIPS:
+		case GSF_AIRCRAFT:
+			return NGCC_VEHICLES;
+
+		case GSF_STATIONS:
+		case GSF_AIRPORTS:
+		case GSF_AIRPORTTILES:
+			return NGCC_STATIONS;
+
+		case GSF_HOUSES:
+			return NGCC_HOUSES;
+
+		case GSF_INDUSTRIES:
+		case GSF_INDUSTRYTILES:
+			return NGCC_INDUSTRIES;
+
+		default:
+			return NGCC_OTHER;
+	}
+}
+
+/**
+ * Attribute the time a timed top level resolve took to its NewGRF.
+ * Only resolves of the main thread are counted, as #_newgrf_costs is not
+ * synchronised; e.g. scripts running on worker threads are not accounted for.
+ * @param object The resolver that was used.
+ * @param time   Time the resolve took, in nanoseconds.
+ */
+void AddNewGRFCostSample(const ResolverObject &object, uint64 time)
+{
+	if (object.grffile == nullptr) return;
+	if (std::this_thread::get_id() != _newgrf_cost_thread) return;
+
+	_newgrf_costs[object.grffile].current[GetNewGRFCostCategory(object.GetFeature())] += time * NEWGRF_COST_SAMPLE_INTERVAL;
+}
+
+/**
+ * Fold the time spent during the last tick into the rolling averages.
+ * To be called once every game tick.
+ */
+void UpdateNewGRFCosts()
+{
+	for (auto &it : _newgrf_costs) {
+		NewGRFCost &cost = it.second;
+		for (NewGRFCostCategory c = NGCC_BEGIN; c < NGCC_END; c++) {
+			cost.average[c] = cost.average[c] - cost.average[c] / NEWGRF_COST_AVERAGE_TICKS + cost.current[c] / NEWGRF_COST_AVERAGE_TICKS;
+			cost.current[c] = 0;
+		}
+	}
+}
+
+/**
+ * Forget the time spent on all NewGRFs.
+ * Must be called before the NewGRF files are freed.
+ */
+void ResetNewGRFCosts()
+{
+	_newgrf_costs.clear();
+}
@@ -19,6 +19,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
 
 /**
  * Callback profiler for NewGRF development
@@ -60,4 +61,47 @@ struct NewGRFProfiler {
 extern std::vector<NewGRFProfiler> _newgrf_profilers;
 extern Date _newgrf_profile_end_date;
 
+/** Groups of features the time spent resolving sprite groups is attributed to. */
+enum NewGRFCostCategory {
+	NGCC_BEGIN = 0,
+	NGCC_VEHICLES = 0, ///< Trains, road vehicles, ships and aircraft.
+	NGCC_STATIONS,     ///< Stations, airports and airport tiles.
+	NGCC_HOUSES,       ///< Houses.
+	NGCC_INDUSTRIES,   ///< Industries and industry tiles.
+	NGCC_OTHER,        ///< All other features.
+	NGCC_END,
+};
+DECLARE_POSTFIX_INCREMENT(NewGRFCostCategory)
+
+/**
+ * Always-on estimate of the time spent resolving the sprite groups of a NewGRF.
+ * Only one in #NEWGRF_COST_SAMPLE_INTERVAL top level resolves is timed, and
+ * counted that many times over, to keep the overhead low.
+ */
+struct NewGRFCost {
+	uint64 current[NGCC_END]; ///< Estimated time spent during the current tick, in nanoseconds.
+	uint64 average[NGCC_END]; ///< Rolling average of the time spent per tick, in nanoseconds.
+
+	/**
+	 * Get the rolling average of the time spent per tick over all categories.
+	 * @return Time spent per tick, in nanoseconds.
+	 */
+	uint64 GetTotalAverage() const
+	{
+		uint64 total = 0;
+		for (NewGRFCostCategory c = NGCC_BEGIN; c < NGCC_END; c++) total += this->average[c];
+		return total;
+	}
+};
+
+static const uint NEWGRF_COST_SAMPLE_INTERVAL = 16; ///< Number of top level resolves per timed one.
+static const uint NEWGRF_COST_AVERAGE_TICKS = 32;   ///< Number of ticks the rolling average roughly covers.
+
+extern thread_local uint _newgrf_cost_countdown;
+extern std::map<const GRFFile *, NewGRFCost> _newgrf_costs;
+
+void AddNewGRFCostSample(const ResolverObject &object, uint64 time);
+void UpdateNewGRFCosts();
+void ResetNewGRFCosts();
+
 #endif /* NEWGRF_PROFILING_H */
@@ -9,6 +9,7 @@
 
 #include "stdafx.h"
 #include <algorithm>
+#include <chrono>
 #include "debug.h"
 #include "newgrf_spritegroup.h"
 #include "newgrf_profiling.h"
@@ -40,8 +41,19 @@ TemporaryStorageArray<int32, 0x110> _temp_store;
 	auto profiler = std::find_if(_newgrf_profilers.begin(), _newgrf_profilers.end(), [&](const NewGRFProfiler &pr) { return pr.grffile == grf; });
 
 	if (profiler == _newgrf_profilers.end() || !profiler->active) {
-		if (top_level) _temp_store.ClearChanges();
-		return group->Resolve(object);
+		if (!top_level) return group->Resolve(object);
+
+		_temp_store.ClearChanges();
+		if (--_newgrf_cost_countdown != 0) return group->Resolve(object);
+
+		/* Time this resolve; top level resolves done while resolving it are part of it, so don't time those. */
+		using namespace std::chrono;
+		_newgrf_cost_countdown = UINT_MAX;
+		steady_clock::time_point start = steady_clock::now();
+		const SpriteGroup *result = group->Resolve(object);
+		AddNewGRFCostSample(object, duration_cast<nanoseconds>(steady_clock::now() - start).count());
+		_newgrf_cost_countdown = NEWGRF_COST_SAMPLE_INTERVAL;
+		return result;
 	} else if (top_level) {
 		profiler->BeginResolve(object);
 		_temp_store.ClearChanges();
@@ -64,6 +76,7 @@ DeterministicSpriteGroup::~DeterministicSpriteGroup()
 {
 	free(this->adjusts);
 	free(this->ranges);
+	free(this->range_table);
 }
 
 RandomizedSpriteGroup::~RandomizedSpriteGroup()
@@ -199,55 +212,173 @@ static U EvalAdjustT(const DeterministicSpriteGroupAdjust *adjust, ScopeResolver
 }
 
 
-static bool RangeHighComparator(const DeterministicSpriteGroupRange& range, uint32 value)
+/**
+ * Evaluate an adjustment for the variable size of a group.
+ * @param size The variable size of the group.
+ * @param adjust The adjustment to evaluate.
+ * @param scope The scope to store into, or \c nullptr when the adjustment does not store.
+ * @param last_value The value of the previous adjustments.
+ * @param value The value of the variable of the adjustment.
+ * @return The new last value.
+ */
+static uint32 EvalAdjust(DeterministicSpriteGroupSize size, const DeterministicSpriteGroupAdjust *adjust, ScopeResolver *scope, uint32 last_value, uint32 value)
 {
-	return range.high < value;
+	switch (size) {
+		case DSG_SIZE_BYTE:  return EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value);
+		case DSG_SIZE_WORD:  return EvalAdjustT<uint16, int16>(adjust, scope, last_value, value);
+		case DSG_SIZE_DWORD: return EvalAdjustT<uint32, int32>(adjust, scope, last_value, value);
+		default: NOT_REACHED();
+	}
 }
 
-const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
+/**
+ * Evaluate the adjustments of a group that were not folded when compiling it.
+ * U is the unsigned type and S is the signed type to use.
+ * @param group The group to evaluate.
+ * @param object The object to resolve for.
+ * @param scope The scope of the group.
+ * @param[in,out] last_value The value of the adjustments before the first evaluated one; the value of all adjustments on return.
+ * @return False if a variable was not available, true otherwise.
+ */
+template <typename U, typename S>
+static bool EvalAdjustsT(const DeterministicSpriteGroup *group, ResolverObject &object, ScopeResolver *scope, uint32 &last_value)
 {
-	uint32 last_value = 0;
-	uint32 value = 0;
-	uint i;
-
-	ScopeResolver *scope = object.GetScope(this->var_scope);
-
-	for (i = 0; i < this->num_adjusts; i++) {
-		DeterministicSpriteGroupAdjust *adjust = &this->adjusts[i];
+	for (uint i = group->first_adjust; i < group->num_adjusts; i++) {
+		const DeterministicSpriteGroupAdjust *adjust = &group->adjusts[i];
 
 		/* Try to get the variable. We shall assume it is available, unless told otherwise. */
 		bool available = true;
-		if (adjust->variable == 0x7E) {
-			const SpriteGroup *subgroup = SpriteGroup::Resolve(adjust->subroutine, object, false);
-			if (subgroup == nullptr) {
-				value = CALLBACK_FAILED;
-			} else {
-				value = subgroup->GetCallbackResult();
+		uint32 value;
+		switch (adjust->source) {
+			case DSGAS_CONSTANT:
+				value = adjust->and_mask;
+				break;
+
+			case DSGAS_SCOPE:
+				value = scope->GetVariable(adjust->variable, adjust->parameter, &available);
+				break;
+
+			case DSGAS_VARIABLE:
+				value = GetVariable(object, scope, adjust->variable, adjust->parameter, &available);
+				break;
+
+			case DSGAS_INDIRECT:
+				value = GetVariable(object, scope, adjust->parameter, last_value, &available);
+				break;
+
+			case DSGAS_SUBROUTINE: {
+				const SpriteGroup *subgroup = SpriteGroup::Resolve(adjust->subroutine, object, false);
+				value = subgroup == nullptr ? CALLBACK_FAILED : subgroup->GetCallbackResult();
+
+				/* Note: 'last_value' and 'reseed' are shared between the main chain and the procedure */
+				break;
 			}
 
-			/* Note: 'last_value' and 'reseed' are shared between the main chain and the procedure */
-		} else if (adjust->variable == 0x7B) {
-			value = GetVariable(object, scope, adjust->parameter, last_value, &available);
-		} else {
-			value = GetVariable(object, scope, adjust->variable, adjust->parameter, &available);
+			default: NOT_REACHED();
 		}
 
-		if (!available) {
-			/* Unsupported variable: skip further processing and return either
-			 * the group from the first range or the default group. */
-			return SpriteGroup::Resolve(this->error_group, object, false);
+		if (!available) return false;
+
+		last_value = EvalAdjustT<U, S>(adjust, scope, last_value, value);
+	}
+
+	return true;
+}
+
+/** Maximum number of values the ranges of a deterministic sprite group may span to get a lookup table. */
+static const uint DSG_MAX_RANGE_TABLE_SIZE = 256;
+
+/**
+ * Prepare the group for resolving. The source of the value of every adjustment
+ * is determined once, the leading adjustments that only work on constants are
+ * folded into the initial value, and when the ranges span just a few values a
+ * table is made to look the resulting group up directly.
+ * @pre The adjustments, ranges and default group are set.
+ */
+void DeterministicSpriteGroup::Compile()
+{
+	for (uint i = 0; i < this->num_adjusts; i++) {
+		DeterministicSpriteGroupAdjust &adjust = this->adjusts[i];
+		switch (adjust.variable) {
+			case 0x1A: // Always -1
+				if (adjust.type == DSGA_TYPE_NONE) {
+					adjust.source = DSGAS_CONSTANT;
+					adjust.and_mask &= UINT32_MAX >> adjust.shift_num;
+					adjust.shift_num = 0;
+				} else {
+					adjust.source = DSGAS_VARIABLE;
+				}
+				break;
+
+			case 0x7B: adjust.source = DSGAS_INDIRECT; break;
+			case 0x7E: adjust.source = DSGAS_SUBROUTINE; break;
+
+			/* Special variables handled by GetVariable. */
+			case 0x5F:
+			case 0x7D:
+			case 0x7F:
+				adjust.source = DSGAS_VARIABLE;
+				break;
+
+			default:
+				adjust.source = adjust.variable >= 0x40 ? DSGAS_SCOPE : DSGAS_VARIABLE;
+				break;
 		}
+	}
 
-		switch (this->size) {
-			case DSG_SIZE_BYTE:  value = EvalAdjustT<uint8,  int8> (adjust, scope, last_value, value); break;
-			case DSG_SIZE_WORD:  value = EvalAdjustT<uint16, int16>(adjust, scope, last_value, value); break;
-			case DSG_SIZE_DWORD: value = EvalAdjustT<uint32, int32>(adjust, scope, last_value, value); break;
-			default: NOT_REACHED();
+	this->initial_value = 0;
+	for (this->first_adjust = 0; this->first_adjust < this->num_adjusts; this->first_adjust++) {
+		const DeterministicSpriteGroupAdjust &adjust = this->adjusts[this->first_adjust];
+		if (adjust.source != DSGAS_CONSTANT) break;
+
+		/* Storing has side effects, and signed division may trap; leave those for resolving. */
+		if (adjust.operation == DSGA_OP_STO || adjust.operation == DSGA_OP_STOP) break;
+		if (adjust.operation == DSGA_OP_SDIV || adjust.operation == DSGA_OP_SMOD) break;
+
+		this->initial_value = EvalAdjust(this->size, &adjust, nullptr, this->initial_value, adjust.and_mask);
+	}
+
+	this->range_table_size = 0;
+	if (this->num_ranges > 4 && this->ranges[this->num_ranges - 1].high - this->ranges[0].low < DSG_MAX_RANGE_TABLE_SIZE) {
+		this->range_table_low = this->ranges[0].low;
+		this->range_table_size = this->ranges[this->num_ranges - 1].high - this->range_table_low + 1;
+		this->range_table = MallocT<const SpriteGroup *>(this->range_table_size);
+		for (uint i = 0; i < this->range_table_size; i++) this->range_table[i] = this->default_group;
+		for (uint i = 0; i < this->num_ranges; i++) {
+			for (uint32 v = this->ranges[i].low - this->range_table_low; v <= this->ranges[i].high - this->range_table_low; v++) {
+				this->range_table[v] = this->ranges[i].group;
+			}
 		}
-		last_value = value;
 	}
+}
 
-	object.last_value = last_value;
+static bool RangeHighComparator(const DeterministicSpriteGroupRange& range, uint32 value)
+{
+	return range.high < value;
+}
+
+const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) const
+{
+	uint32 value = this->initial_value;
+	uint i;
+
+	ScopeResolver *scope = object.GetScope(this->var_scope);
+
+	bool available;
+	switch (this->size) {
+		case DSG_SIZE_BYTE:  available = EvalAdjustsT<uint8,  int8> (this, object, scope, value); break;
+		case DSG_SIZE_WORD:  available = EvalAdjustsT<uint16, int16>(this, object, scope, value); break;
+		case DSG_SIZE_DWORD: available = EvalAdjustsT<uint32, int32>(this, object, scope, value); break;
+		default: NOT_REACHED();
+	}
+
+	if (!available) {
+		/* Unsupported variable: skip further processing and return either
+		 * the group from the first range or the default group. */
+		return SpriteGroup::Resolve(this->error_group, object, false);
+	}
+
+	object.last_value = value;
 
 	if (this->calculated_result) {
 		/* nvar == 0 is a special case -- we turn our value into a callback result */
@@ -257,6 +388,11 @@ const SpriteGroup *DeterministicSpriteGroup::Resolve(ResolverObject &object) con
 		return &nvarzero;
 	}
 
+	if (this->range_table_size != 0) {
+		uint32 offset = value - this->range_table_low;
+		return SpriteGroup::Resolve(offset < this->range_table_size ? this->range_table[offset] : this->default_group, object, false);
+	}
+
 	if (this->num_ranges > 4) {
 		DeterministicSpriteGroupRange *lower = std::lower_bound(this->ranges + 0, this->ranges + this->num_ranges, value, RangeHighComparator);
 		if (lower != this->ranges + this->num_ranges && lower->low <= value) {
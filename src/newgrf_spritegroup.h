@@ -147,9 +147,20 @@ enum DeterministicSpriteGroupAdjustOperation {
 };
 
 
+/** Where the value of an adjust comes from; determined when the sprite group is compiled. */
+enum DeterministicSpriteGroupAdjustSource {
+	DSGAS_VARIABLE,   ///< Global, special or feature specific variable.
+	DSGAS_SCOPE,      ///< Feature specific variable, straight from the scope.
+	DSGAS_CONSTANT,   ///< Constant value, already shifted and masked, in \c and_mask.
+	DSGAS_INDIRECT,   ///< Variable given by the parameter, with the last value as its parameter (variable 7B).
+	DSGAS_SUBROUTINE, ///< Result of a procedure call (variable 7E).
+};
+
+
 struct DeterministicSpriteGroupAdjust {
 	DeterministicSpriteGroupAdjustOperation operation;
 	DeterministicSpriteGroupAdjustType type;
+	DeterministicSpriteGroupAdjustSource source;
 	byte variable;
 	byte parameter; ///< Used for variables between 0x60 and 0x7F inclusive.
 	byte shift_num;
@@ -184,6 +195,14 @@ struct DeterministicSpriteGroup : SpriteGroup {
 
 	const SpriteGroup *error_group; // was first range, before sorting ranges
 
+	uint first_adjust;                ///< First adjust to evaluate; the ones before it are folded into \c initial_value.
+	uint32 initial_value;             ///< The last value after evaluating the adjusts before \c first_adjust.
+	uint32 range_table_low;           ///< Value of the first entry of \c range_table.
+	uint range_table_size;            ///< Number of entries in \c range_table; 0 when the ranges are searched.
+	const SpriteGroup **range_table;  ///< The group to resolve for every value from \c range_table_low, if the ranges span few values.
+
+	void Compile();
+
 protected:
 	const SpriteGroup *Resolve(ResolverObject &object) const;
 };
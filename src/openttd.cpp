@@ -65,6 +65,7 @@
 #include "viewport_sprite_sorter.h"
 #include "framerate_type.h"
 #include "industry.h"
+#include "newgrf_profiling.h"
 
 #include "linkgraph/linkgraphschedule.h"
 
@@ -1394,6 +1395,7 @@ void StateGameLoop()
 
 	PerformanceMeasurer framerate(PFE_GAMELOOP);
 	PerformanceAccumulator::Reset(PFE_GL_LANDSCAPE);
+	UpdateNewGRFCosts();
 	if (HasModalProgress()) return;
 
 	Layouter::ReduceLineCache();
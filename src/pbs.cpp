@@ -12,9 +12,67 @@
 #include "vehicle_func.h"
 #include "newgrf_station.h"
 #include "pathfinder/follow_track.hpp"
+#include "train.h"
+
+#include <map>
 
 #include "safeguards.h"
 
+TileIndex _path_reservation_blocked_tile = INVALID_TILE; ///< Tile of which the reservation blocked the last failed path reservation.
+
+/** Stuck trains waiting for the release of a reservation, by the tile of that reservation. */
+static std::multimap<TileIndex, VehicleID> _path_reservation_waits;
+
+/**
+ * Let a stuck train wait for the release of the reservation that blocked its path.
+ * @param v The stuck train.
+ * @param tile The tile of the reservation, or INVALID_TILE to not wait.
+ */
+void WaitForPathReservationRelease(Train *v, TileIndex tile)
+{
+	/* The train retries its path regularly; don't add another entry every time. */
+	if (v->path_wait_tile == tile) return;
+
+	v->path_wait_tile = tile;
+	if (tile != INVALID_TILE) _path_reservation_waits.insert(std::make_pair(tile, v->index));
+}
+
+/**
+ * Wake the trains waiting for the release of a reservation on a tile.
+ * @param tile The tile of which a reservation has been released.
+ */
+void WakeTrainsWaitingForPath(TileIndex tile)
+{
+	if (_path_reservation_waits.empty()) return;
+
+	auto range = _path_reservation_waits.equal_range(tile);
+	for (auto it = range.first; it != range.second; ++it) {
+		/* The train might have stopped waiting, or might be waiting for another tile already. */
+		Train *v = Train::GetIfValid(it->second);
+		if (v != nullptr && v->path_wait_tile == tile) v->path_wait_tile = INVALID_TILE;
+	}
+	_path_reservation_waits.erase(range.first, range.second);
+}
+
+/** Wake all trains waiting for the release of a reservation, as something else changed. */
+void WakeAllTrainsWaitingForPath()
+{
+	for (const auto &wait : _path_reservation_waits) {
+		Train *v = Train::GetIfValid(wait.second);
+		if (v != nullptr && v->path_wait_tile == wait.first) v->path_wait_tile = INVALID_TILE;
+	}
+	_path_reservation_waits.clear();
+}
+
+/** Rebuild the trains waiting for the release of a reservation after loading or starting a game. */
+void RebuildPathReservationWaits()
+{
+	_path_reservation_waits.clear();
+	for (const Train *v : Train::Iterate()) {
+		if (v->path_wait_tile != INVALID_TILE) _path_reservation_waits.insert(std::make_pair(v->path_wait_tile, v->index));
+	}
+}
+
 /**
  * Get the reserved trackbits for any tile, regardless of type.
  * @param t the tile
@@ -64,6 +122,7 @@ void SetRailStationPlatformReservation(TileIndex start, DiagDirection dir, bool
 
 	do {
 		SetRailStationReservation(tile, b);
+		if (!b) WakeTrainsWaitingForPath(tile);
 		MarkTileDirtyByTile(tile);
 		tile = TILE_ADD(tile, diff);
 	} while (IsCompatibleTrainStationTile(tile, start));
@@ -181,6 +240,8 @@ void UnreserveRailTrack(TileIndex tile, Track t)
 		default:
 			break;
 	}
+
+	WakeTrainsWaitingForPath(tile);
 }
 
 
@@ -422,15 +483,19 @@ bool IsSafeWaitingPosition(const Train *v, TileIndex tile, Trackdir trackdir, bo
  * @param tile The tile
  * @param trackdir The trackdir to test
  * @param forbid_90deg Don't allow trains to make 90 degree turns
+ * @param[out] blocked_tile If not \c nullptr, set to the tile of the reservation making the position not free.
  * @return True if the position is free
  */
-bool IsWaitingPositionFree(const Train *v, TileIndex tile, Trackdir trackdir, bool forbid_90deg)
+bool IsWaitingPositionFree(const Train *v, TileIndex tile, Trackdir trackdir, bool forbid_90deg, TileIndex *blocked_tile)
 {
 	Track     track = TrackdirToTrack(trackdir);
 	TrackBits reserved = GetReservedTrackbits(tile);
 
 	/* Tile reserved? Can never be a free waiting position. */
-	if (TrackOverlapsTracks(reserved, track)) return false;
+	if (TrackOverlapsTracks(reserved, track)) {
+		if (blocked_tile != nullptr) *blocked_tile = tile;
+		return false;
+	}
 
 	/* Not reserved and depot or not a pbs signal -> free. */
 	if (IsRailDepotTile(tile)) return true;
@@ -445,5 +510,8 @@ bool IsWaitingPositionFree(const Train *v, TileIndex tile, Trackdir trackdir, bo
 	ft.m_new_td_bits &= DiagdirReachesTrackdirs(ft.m_exitdir);
 	if (Rail90DegTurnDisallowed(GetTileRailType(ft.m_old_tile), GetTileRailType(ft.m_new_tile), forbid_90deg)) ft.m_new_td_bits &= ~TrackdirCrossesTrackdirs(trackdir);
 
-	return !HasReservedTracks(ft.m_new_tile, TrackdirBitsToTrackBits(ft.m_new_td_bits));
+	if (!HasReservedTracks(ft.m_new_tile, TrackdirBitsToTrackBits(ft.m_new_td_bits))) return true;
+
+	if (blocked_tile != nullptr) *blocked_tile = ft.m_new_tile;
+	return false;
 }
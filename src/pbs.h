@@ -44,10 +44,17 @@ struct PBSTileInfo {
 
 PBSTileInfo FollowTrainReservation(const Train *v, Vehicle **train_on_res = nullptr);
 bool IsSafeWaitingPosition(const Train *v, TileIndex tile, Trackdir trackdir, bool include_line_end, bool forbid_90deg = false);
-bool IsWaitingPositionFree(const Train *v, TileIndex tile, Trackdir trackdir, bool forbid_90deg = false);
+bool IsWaitingPositionFree(const Train *v, TileIndex tile, Trackdir trackdir, bool forbid_90deg = false, TileIndex *blocked_tile = nullptr);
 
 Train *GetTrainForReservation(TileIndex tile, Track track);
 
+extern TileIndex _path_reservation_blocked_tile;
+
+void WaitForPathReservationRelease(Train *v, TileIndex tile);
+void WakeTrainsWaitingForPath(TileIndex tile);
+void WakeAllTrainsWaitingForPath();
+void RebuildPathReservationWaits();
+
 /**
  * Check whether some of tracks is reserved on a tile.
  *
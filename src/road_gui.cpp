@@ -1071,8 +1071,6 @@ struct BuildRoadStationWindow : public PickerWindowBase {
 		this->LowerWidget(_settings_client.gui.station_show_coverage + WID_BROS_LT_OFF);
 
 		this->FinishInitNested(TRANSPORT_ROAD);
-
-		this->window_class = (rs == ROADSTOP_BUS) ? WC_BUS_STATION : WC_TRUCK_STATION;
 	}
 
 	virtual ~BuildRoadStationWindow()
@@ -1200,13 +1198,20 @@ static const NWidgetPart _nested_road_station_picker_widgets[] = {
 	EndContainer(),
 };
 
-static WindowDesc _road_station_picker_desc(
+static WindowDesc _road_bus_station_picker_desc(
 	WDP_AUTO, nullptr, 0, 0,
 	WC_BUS_STATION, WC_BUILD_TOOLBAR,
 	WDF_CONSTRUCTION,
 	_nested_road_station_picker_widgets, lengthof(_nested_road_station_picker_widgets)
 );
 
+static WindowDesc _road_truck_station_picker_desc(
+	WDP_AUTO, nullptr, 0, 0,
+	WC_TRUCK_STATION, WC_BUILD_TOOLBAR,
+	WDF_CONSTRUCTION,
+	_nested_road_station_picker_widgets, lengthof(_nested_road_station_picker_widgets)
+);
+
 /** Widget definition of the build tram station window */
 static const NWidgetPart _nested_tram_station_picker_widgets[] = {
 	NWidget(NWID_HORIZONTAL),
@@ -1238,16 +1243,29 @@ static const NWidgetPart _nested_tram_station_picker_widgets[] = {
 	EndContainer(),
 };
 
-static WindowDesc _tram_station_picker_desc(
+static WindowDesc _tram_bus_station_picker_desc(
 	WDP_AUTO, nullptr, 0, 0,
 	WC_BUS_STATION, WC_BUILD_TOOLBAR,
 	WDF_CONSTRUCTION,
 	_nested_tram_station_picker_widgets, lengthof(_nested_tram_station_picker_widgets)
 );
 
+static WindowDesc _tram_truck_station_picker_desc(
+	WDP_AUTO, nullptr, 0, 0,
+	WC_TRUCK_STATION, WC_BUILD_TOOLBAR,
+	WDF_CONSTRUCTION,
+	_nested_tram_station_picker_widgets, lengthof(_nested_tram_station_picker_widgets)
+);
+
 static void ShowRVStationPicker(Window *parent, RoadStopType rs)
 {
-	new BuildRoadStationWindow(RoadTypeIsRoad(_cur_roadtype) ? &_road_station_picker_desc : &_tram_station_picker_desc, parent, rs);
+	WindowDesc *desc;
+	if (RoadTypeIsRoad(_cur_roadtype)) {
+		desc = (rs == ROADSTOP_BUS) ? &_road_bus_station_picker_desc : &_road_truck_station_picker_desc;
+	} else {
+		desc = (rs == ROADSTOP_BUS) ? &_tram_bus_station_picker_desc : &_tram_truck_station_picker_desc;
+	}
+	new BuildRoadStationWindow(desc, parent, rs);
 }
 
 void InitializeRoadGui()
@@ -713,6 +713,9 @@ bool AfterLoadGame()
 	 * must be done before loading sprites as some newgrfs check it */
 	SetDate(_date, _date_fract);
 
+	/* Older versions did all monthly work on the first tick of the month. */
+	if (IsSavegameVersionBefore(SLV_MONTHLY_SPREAD)) _new_month_pending = false;
+
 	/*
 	 * Force the old behaviour for compatibility reasons with old savegames. As new
 	 * settings can only be loaded from new savegames loading old savegames with new
@@ -797,6 +800,9 @@ bool AfterLoadGame()
 		}
 	}
 
+	/* The vehicle hash was sized for the map before loading; size it for the loaded map. */
+	ResetVehicleHash();
+
 	/* Update all vehicles */
 	AfterLoadVehicles(true);
 
@@ -90,6 +90,7 @@ static const SaveLoadGlobVarList _date_desc[] = {
 	    SLEG_VAR(_trees_tick_ctr,         SLE_UINT8),
 	SLEG_CONDVAR(_pause_mode,             SLE_UINT8,                   SLV_4, SL_MAX_VERSION),
 	SLE_CONDNULL(4, SLV_11, SLV_120),
+	SLEG_CONDVAR(_new_month_pending,      SLE_BOOL,                    SLV_MONTHLY_SPREAD, SL_MAX_VERSION),
 	    SLEG_END()
 };
 
@@ -115,6 +116,7 @@ static const SaveLoadGlobVarList _date_check_desc[] = {
 	    SLE_NULL(1),                       // _trees_tick_ctr
 	SLE_CONDNULL(1, SLV_4, SL_MAX_VERSION),    // _pause_mode
 	SLE_CONDNULL(4, SLV_11, SLV_120),
+	SLE_CONDNULL(1, SLV_MONTHLY_SPREAD, SL_MAX_VERSION), // _new_month_pending
 	    SLEG_END()
 };
 
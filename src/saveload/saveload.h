@@ -302,6 +302,9 @@ enum SaveLoadVersion : uint16 {
 	SLV_MULTITILE_DOCKS,                    ///< 216  PR#7380 Multiple docks per station.
 	SLV_TRADING_AGE,                        ///< 217  PR#7780 Configurable company trading age.
 	SLV_ENDING_YEAR,                        ///< 218  PR#7747 v1.10 Configurable ending year.
+	SLV_SCRIPT_BINARY_DATA,                 ///< 219  Binary serialisation of script save data.
+	SLV_PATH_WAIT_TILE,                     ///< 220  Stuck trains wait for the release of the reservation blocking them.
+	SLV_MONTHLY_SPREAD,                     ///< 221  Monthly town and industry work spread over the first day of the month.
 
 	SL_MAX_VERSION,                         ///< Highest possible saveload version
 };
@@ -18,6 +18,7 @@
 #include "../company_base.h"
 #include "../company_func.h"
 #include "../disaster_vehicle.h"
+#include "../pbs.h"
 
 #include "saveload.h"
 
@@ -473,6 +474,8 @@ void AfterLoadVehicles(bool part_of_load)
 		v->UpdatePosition();
 		v->UpdateViewport(false);
 	}
+
+	RebuildPathReservationWaits();
 }
 
 bool TrainController(Train *v, Vehicle *nomove, bool reverse = true); // From train_cmd.cpp
@@ -728,6 +731,7 @@ const SaveLoad *GetVehicleDescription(VehicleType vt)
 		SLE_CONDNULL(2, SLV_2, SLV_60),
 
 		 SLE_CONDVAR(Train, wait_counter,        SLE_UINT16,                 SLV_136, SL_MAX_VERSION),
+		 SLE_CONDVAR(Train, path_wait_tile,      SLE_UINT32,                 SLV_PATH_WAIT_TILE, SL_MAX_VERSION),
 
 		SLE_CONDNULL(2, SLV_2, SLV_20),
 		 SLE_CONDVAR(Train, gv_flags,            SLE_UINT16,                 SLV_139, SL_MAX_VERSION),
@@ -24,6 +24,7 @@
 #include "window_func.h"
 #include "tile_map.h"
 #include "landscape.h"
+#include "thread_pool.h"
 
 #include "table/strings.h"
 
@@ -223,6 +224,9 @@ static bool MakeBMPImage(const char *name, ScreenshotCallback *callb, void *user
  *********************************************************/
 #if defined(WITH_PNG)
 #include <png.h>
+#include <condition_variable>
+#include <mutex>
+#include "thread.h"
 
 #ifdef PNG_TEXT_SUPPORTED
 #include "rev.h"
@@ -243,6 +247,102 @@ static void PNGAPI png_my_warning(png_structp png_ptr, png_const_charp message)
 	DEBUG(misc, 1, "[libpng] warning: %s - %s", message, (const char *)png_get_error_ptr(png_ptr));
 }
 
+/**
+ * Hand over of rendered lines from the thread rendering a .PNG screenshot to
+ * the thread compressing it, so the next lines are rendered while the previous
+ * ones are compressed.
+ */
+struct PNGLineWriter {
+	png_structp png_ptr;         ///< The image being written.
+	png_infop info_ptr;          ///< Information about the image being written.
+	uint row_size;               ///< Number of bytes of a line.
+
+	std::mutex lock;             ///< Lock for everything below.
+	std::condition_variable cv;  ///< Signalled when lines are handed over or written, or when writing stopped.
+	uint8 *lines;                ///< Lines waiting to be written, or \c nullptr when there are none.
+	uint num_lines;              ///< Number of lines waiting to be written.
+	bool done;                   ///< Whether all lines have been handed over.
+	bool failed;                 ///< Whether writing the image failed.
+
+	/**
+	 * Create the writer of an image.
+	 * @param png_ptr The image to write.
+	 * @param info_ptr Information about the image.
+	 * @param row_size Number of bytes of a line.
+	 */
+	PNGLineWriter(png_structp png_ptr, png_infop info_ptr, uint row_size) :
+		png_ptr(png_ptr), info_ptr(info_ptr), row_size(row_size), lines(nullptr), num_lines(0), done(false), failed(false)
+	{
+	}
+
+	/**
+	 * Hand over lines to write. Waits till the lines handed over before are written,
+	 * after which the buffer of those lines may be reused.
+	 * @param lines The lines to write; must stay valid till the next call.
+	 * @param num_lines Number of lines to write.
+	 * @return Whether writing has not failed so far.
+	 */
+	bool Write(uint8 *lines, uint num_lines)
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->cv.wait(guard, [&]() { return this->lines == nullptr || this->failed; });
+		if (this->failed) return false;
+
+		this->lines = lines;
+		this->num_lines = num_lines;
+		this->cv.notify_all();
+		return true;
+	}
+
+	/**
+	 * Tell that all lines have been handed over. The image is only completely
+	 * written, and #failed final, once the thread running the writer has ended.
+	 */
+	void Finish()
+	{
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->cv.wait(guard, [&]() { return this->lines == nullptr || this->failed; });
+		this->done = true;
+		this->cv.notify_all();
+	}
+
+	/**
+	 * Compress and write the lines handed over, till all lines are written.
+	 * @param writer The writer to run.
+	 */
+	static void Run(PNGLineWriter *writer)
+	{
+		if (setjmp(png_jmpbuf(writer->png_ptr))) {
+			std::lock_guard<std::mutex> guard(writer->lock);
+			writer->failed = true;
+			writer->cv.notify_all();
+			return;
+		}
+
+		for (;;) {
+			uint8 *lines;
+			uint num_lines;
+			{
+				std::unique_lock<std::mutex> guard(writer->lock);
+				writer->cv.wait(guard, [&]() { return writer->lines != nullptr || writer->done; });
+				if (writer->lines == nullptr) break;
+				lines = writer->lines;
+				num_lines = writer->num_lines;
+			}
+
+			for (uint i = 0; i != num_lines; i++) {
+				png_write_row(writer->png_ptr, (png_bytep)lines + i * writer->row_size);
+			}
+
+			std::lock_guard<std::mutex> guard(writer->lock);
+			writer->lines = nullptr;
+			writer->cv.notify_all();
+		}
+
+		png_write_end(writer->png_ptr, writer->info_ptr);
+	}
+};
+
 /**
  * Generic .PNG file image writer.
  * @param name        Filename, including extension.
@@ -368,30 +468,52 @@ static bool MakePNGImage(const char *name, ScreenshotCallback *callb, void *user
 	/* use by default 64k temp memory */
 	maxlines = Clamp(65536 / w, 16, 128);
 
-	/* now generate the bitmap bits */
-	void *buff = CallocT<uint8>(w * maxlines * bpp); // by default generate 128 lines at a time.
+	/* now generate the bitmap bits; while one buffer is compressed, the other one is rendered */
+	uint8 *buffs[2];
+	buffs[0] = CallocT<uint8>(w * maxlines * bpp * 2); // by default generate 128 lines at a time.
+	buffs[1] = buffs[0] + w * maxlines * bpp;
+
+	/* Compressing the image is done on a thread of its own; from now on only that thread uses libpng. */
+	PNGLineWriter writer(png_ptr, info_ptr, w * bpp);
+	std::thread writer_thread;
+	bool threaded = StartNewThread(&writer_thread, "ottd:png", &PNGLineWriter::Run, &writer);
+	bool success = true;
 
 	y = 0;
-	do {
+	for (uint cur = 0; y != h; cur ^= 1) {
 		/* determine # lines to write */
 		n = min(h - y, maxlines);
 
 		/* render the pixels into the buffer */
-		callb(userdata, buff, y, w, n);
+		callb(userdata, buffs[cur], y, w, n);
 		y += n;
 
 		/* write them to png */
-		for (i = 0; i != n; i++) {
-			png_write_row(png_ptr, (png_bytep)buff + i * w * bpp);
+		if (threaded) {
+			if (!writer.Write(buffs[cur], n)) {
+				success = false;
+				break;
+			}
+		} else {
+			for (i = 0; i != n; i++) {
+				png_write_row(png_ptr, (png_bytep)buffs[cur] + i * w * bpp);
+			}
 		}
-	} while (y != h);
+	}
 
-	png_write_end(png_ptr, info_ptr);
+	if (threaded) {
+		writer.Finish();
+		writer_thread.join();
+		/* Writing the end of the image may fail too, so only check after the thread ended. */
+		if (writer.failed) success = false;
+	} else {
+		png_write_end(png_ptr, info_ptr);
+	}
 	png_destroy_write_struct(&png_ptr, &info_ptr);
 
-	free(buff);
+	free(buffs[0]);
 	fclose(f);
-	return true;
+	return success;
 }
 #endif /* WITH_PNG */
 
@@ -655,6 +777,11 @@ static void LargeWorldCallback(void *userdata, void *buf, uint y, uint pitch, ui
 	/* Switch back to rendering to the screen */
 	_screen = old_screen;
 	_screen_disable_anim = old_disable_anim;
+
+	/* Large screenshots can take a long time, so tell how far along we are every 10 percent. */
+	if ((y + n) * 10 / vp->height != y * 10 / vp->height) {
+		DEBUG(misc, 1, "Screenshot: %u of %u lines rendered", y + n, vp->height);
+	}
 }
 
 /**
@@ -922,7 +1049,7 @@ static Owner GetMinimapOwner(TileIndex tile)
 static void MinimapScreenCallback(void *userdata, void *buf, uint y, uint pitch, uint n)
 {
 	/* Fill with the company colours */
-	byte owner_colours[OWNER_END + 1];
+	byte owner_colours[OWNER_END + 1] = {};
 	for (const Company *c : Company::Iterate()) {
 		owner_colours[c->index] = MKCOLOUR(_colour_gradient[c->colour][5]);
 	}
@@ -934,24 +1061,24 @@ static void MinimapScreenCallback(void *userdata, void *buf, uint y, uint pitch,
 	owner_colours[OWNER_DEITY]   = PC_DARK_GREY; // industry
 	owner_colours[OWNER_END]     = PC_BLACK;
 
-	uint32 *ubuf = (uint32 *)buf;
-	uint num = (pitch * n);
-	for (uint i = 0; i < num; i++) {
-		uint row = y + (int)(i / pitch);
-		uint col = (MapSizeX() - 1) - (i % pitch);
-
-		TileIndex tile = TileXY(col, row);
-		Owner o = GetMinimapOwner(tile);
-		byte val = owner_colours[o];
+	/* Look up the pixel of each owner once, instead of for every tile. */
+	uint32 owner_pixels[OWNER_END + 1];
+	for (uint i = 0; i < lengthof(owner_pixels); i++) {
+		const Colour &colour = _cur_palette.palette[owner_colours[i]];
+		owner_pixels[i] = (colour.b << 0) | (colour.g << 8) | (colour.r << 16); // Skip alpha
+	}
 
-		uint32 colour_buf = 0;
-		colour_buf  = (_cur_palette.palette[val].b << 0);
-		colour_buf |= (_cur_palette.palette[val].g << 8);
-		colour_buf |= (_cur_palette.palette[val].r << 16);
+	/* The rows only read the map, so they are generated in parallel. */
+	static ThreadPool thread_pool("ottd:minimap");
+	thread_pool.Run(n, [&](uint index) {
+		uint32 *ubuf = (uint32 *)buf + index * pitch;
 
-		*ubuf = colour_buf;
-		ubuf++;   // Skip alpha
-	}
+		/* The columns run from the east to the west edge of the map. */
+		TileIndex tile = TileXY(MapMaxX(), y + index);
+		for (uint col = 0; col < pitch; col++, tile--) {
+			ubuf[col] = owner_pixels[GetMinimapOwner(tile)];
+		}
+	});
 }
 
 /**
@@ -17,6 +17,22 @@
  *
  * This version is not yet released. The following changes are not set in stone yet.
  *
+ * API additions:
+ * \li AITileList::ValuateSlope
+ * \li AITileList::ValuateBuildable
+ * \li AITileList::ValuateDistanceManhattanToTile
+ * \li AITileList::ValuateDistanceSquareToTile
+ * \li AITileList::ValuateCargoAcceptance
+ * \li AIVehicleList::ValuateProfitThisYear
+ * \li AIVehicleList::ValuateProfitLastYear
+ * \li AIVehicleList::ValuateAge
+ * \li AIVehicleList::ValuateState
+ *
+ * Other changes:
+ * \li AIVehicleList_* classes now derive from AIVehicleList
+ * \li Strings in the save data are no longer limited to 254 characters
+ * \li Integers in the save data are no longer truncated to 32 bits
+ *
  * \b 1.10.0
  *
  * API additions:
@@ -17,6 +17,22 @@
  *
  * This version is not yet released. The following changes are not set in stone yet.
  *
+ * API additions:
+ * \li GSTileList::ValuateSlope
+ * \li GSTileList::ValuateBuildable
+ * \li GSTileList::ValuateDistanceManhattanToTile
+ * \li GSTileList::ValuateDistanceSquareToTile
+ * \li GSTileList::ValuateCargoAcceptance
+ * \li GSVehicleList::ValuateProfitThisYear
+ * \li GSVehicleList::ValuateProfitLastYear
+ * \li GSVehicleList::ValuateAge
+ * \li GSVehicleList::ValuateState
+ *
+ * Other changes:
+ * \li GSVehicleList_* classes now derive from GSVehicleList
+ * \li Strings in the save data are no longer limited to 254 characters
+ * \li Integers in the save data are no longer truncated to 32 bits
+ *
  * \b 1.10.0
  *
  * API additions:
@@ -12,14 +12,18 @@
 #include "script_error.hpp"
 #include "../../network/network.h"
 #include "../../core/random_func.hpp"
+#include "../squirrel.hpp"
 
 #include "../../safeguards.h"
 
 /* static */ uint32 ScriptBase::Rand()
 {
 	/* We pick RandomRange if we are in SP (so when saved, we do the same over and over)
-	 *   but we pick InteractiveRandomRange if we are a network_server or network-client. */
+	 *   but we pick InteractiveRandomRange if we are a network_server or network-client.
+	 * Scripts running on worker threads draw in no fixed order, so they use their own
+	 *   random, which is seeded from the game's random. */
 	if (_networking) return ::InteractiveRandom();
+	if (ScriptNativeScope::IsThreaded()) return ScriptObject::GetThreadedRandom().Next();
 	return ::Random();
 }
 
@@ -33,6 +37,7 @@
 	/* We pick RandomRange if we are in SP (so when saved, we do the same over and over)
 	 *   but we pick InteractiveRandomRange if we are a network_server or network-client. */
 	if (_networking) return ::InteractiveRandomRange(max);
+	if (ScriptNativeScope::IsThreaded()) return ScriptObject::GetThreadedRandom().Next(max);
 	return ::RandomRange(max);
 }
 
@@ -10,404 +10,586 @@
 #include "../../stdafx.h"
 #include "script_list.hpp"
 #include "script_controller.hpp"
+#include "../script_instance.hpp"
 #include "../../debug.h"
 #include "../../script/squirrel.hpp"
+#include "../../core/bitmath_func.hpp"
+#include <algorithm>
+#include <vector>
 
 #include "../../safeguards.h"
 
+/** An item of a ScriptList together with its value. */
+struct ScriptListEntry {
+	int64 item;  ///< The item.
+	int64 value; ///< The value belonging to the item.
+};
+
+/** Ordering of ScriptListEntry by value and item, or by item only. */
+struct ScriptListEntryLess {
+	bool by_value; ///< Whether to order on value first.
+
+	bool operator()(const ScriptListEntry &a, const ScriptListEntry &b) const
+	{
+		if (this->by_value && a.value != b.value) return a.value < b.value;
+		return a.item < b.item;
+	}
+};
+
+typedef std::vector<ScriptListEntry> ScriptListEntryVector; ///< A flat list of entries.
+
 /**
- * Base class for any ScriptList sorter.
+ * The items of a ScriptList. All item/value pairs are stored in one flat
+ * vector in no particular order; an open addressing hash table with linear
+ * probing maps the items to their place in that vector. Adding, changing
+ * and removing items thus does not allocate once the storage has grown.
  */
-class ScriptListSorter {
-protected:
-	ScriptList *list;       ///< The list that's being sorted.
-	bool has_no_more_items; ///< Whether we have more items to iterate over.
-	int64 item_next;        ///< The next item we will show.
-
+class ScriptListItems {
 public:
-	/**
-	 * Virtual dtor, needed to mute warnings.
-	 */
-	virtual ~ScriptListSorter() { }
+	static const size_t NOT_FOUND = SIZE_MAX; ///< Result of Find() when the item is not in the list.
 
-	/**
-	 * Get the first item of the sorter.
-	 */
-	virtual int64 Begin() = 0;
+	ScriptListEntryVector entries; ///< All items with their value.
 
-	/**
-	 * Stop iterating a sorter.
-	 */
-	virtual void End() = 0;
+private:
+	std::vector<uint32> slots; ///< The hash table; the index in #entries plus one, or 0 for an empty slot.
+	uint hash_shift;           ///< Shift to get the hash of an item; 64 minus the log2 of the table size.
 
 	/**
-	 * Get the next item of the sorter.
+	 * Get the slot an item would ideally be placed in.
+	 * @param item The item to get the slot for.
+	 * @return The slot.
 	 */
-	virtual int64 Next() = 0;
+	inline size_t GetHomeSlot(int64 item) const
+	{
+		/* Fibonacci hashing, as items are usually dense indices like tiles or pool items. */
+		return (size_t)(((uint64)item * 0x9E3779B97F4A7C15ULL) >> this->hash_shift);
+	}
 
 	/**
-	 * See if the sorter has reached the end.
+	 * Find the slot holding the item, or the empty slot where it should go.
+	 * @param item The item to look for.
+	 * @return The slot.
+	 * @pre !this->slots.empty()
 	 */
-	bool IsEnd()
+	size_t FindSlot(int64 item) const
 	{
-		return this->list->buckets.empty() || this->has_no_more_items;
+		size_t mask = this->slots.size() - 1;
+		for (size_t slot = this->GetHomeSlot(item);; slot = (slot + 1) & mask) {
+			uint32 index = this->slots[slot];
+			if (index == 0 || this->entries[index - 1].item == item) return slot;
+		}
 	}
 
 	/**
-	 * Callback from the list if an item gets removed.
+	 * Resize the hash table and place all entries again.
+	 * @param size The new number of slots, a power of two.
 	 */
-	virtual void Remove(int item) = 0;
+	void Rehash(size_t size)
+	{
+		this->slots.assign(size, 0);
+		this->hash_shift = 64 - FindLastBit(size);
+		for (size_t i = 0; i < this->entries.size(); i++) {
+			this->slots[this->FindSlot(this->entries[i].item)] = (uint32)i + 1;
+		}
+	}
 
 	/**
-	 * Attach the sorter to a new list. This assumes the content of the old list has been moved to
-	 * the new list, too, so that we don't have to invalidate any iterators. Note that std::swap
-	 * doesn't invalidate iterators on lists and maps, so that should be safe.
-	 * @param target New list to attach to.
+	 * Empty a slot, moving later entries of the probe sequence back so they can still be found.
+	 * @param hole The slot to empty.
 	 */
-	virtual void Retarget(ScriptList *new_list)
+	void ClearSlot(size_t hole)
 	{
-		this->list = new_list;
+		size_t mask = this->slots.size() - 1;
+		for (size_t next = (hole + 1) & mask; this->slots[next] != 0; next = (next + 1) & mask) {
+			size_t home = this->GetHomeSlot(this->entries[this->slots[next] - 1].item);
+			/* Only move the entry when the hole lies between its home slot and its current slot. */
+			if (((next - home) & mask) < ((next - hole) & mask)) continue;
+			this->slots[hole] = this->slots[next];
+			hole = next;
+		}
+		this->slots[hole] = 0;
 	}
-};
-
-/**
- * Sort by value, ascending.
- */
-class ScriptListSorterValueAscending : public ScriptListSorter {
-private:
-	ScriptList::ScriptListBucket::iterator bucket_iter;    ///< The iterator over the list to find the buckets.
-	ScriptList::ScriptItemList *bucket_list;               ///< The current bucket list we're iterator over.
-	ScriptList::ScriptItemList::iterator bucket_list_iter; ///< The iterator over the bucket list.
 
 public:
+	ScriptListItems() : hash_shift(64) {}
+
 	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
+	 * Find an item.
+	 * @param item The item to look for.
+	 * @return The index in #entries, or NOT_FOUND.
 	 */
-	ScriptListSorterValueAscending(ScriptList *list)
+	size_t Find(int64 item) const
 	{
-		this->list = list;
-		this->End();
+		if (this->entries.empty()) return NOT_FOUND;
+		uint32 index = this->slots[this->FindSlot(item)];
+		return index == 0 ? NOT_FOUND : index - 1;
 	}
 
-	int64 Begin()
+	/**
+	 * Add an item, unless it is already there.
+	 * @param item The item to add.
+	 * @param value The value of the item.
+	 * @return True if the item has been added.
+	 */
+	bool Insert(int64 item, int64 value)
 	{
-		if (this->list->buckets.empty()) return 0;
-		this->has_no_more_items = false;
+		/* Keep the load factor at most one half, so probe sequences stay short. */
+		if ((this->entries.size() + 1) * 2 > this->slots.size()) this->Rehash(max<size_t>(16, this->slots.size() * 2));
 
-		this->bucket_iter = this->list->buckets.begin();
-		this->bucket_list = &(*this->bucket_iter).second;
-		this->bucket_list_iter = this->bucket_list->begin();
-		this->item_next = *this->bucket_list_iter;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
-	}
+		size_t slot = this->FindSlot(item);
+		if (this->slots[slot] != 0) return false;
 
-	void End()
-	{
-		this->bucket_list = nullptr;
-		this->has_no_more_items = true;
-		this->item_next = 0;
+		this->entries.push_back({item, value});
+		this->slots[slot] = (uint32)this->entries.size();
+		return true;
 	}
 
 	/**
-	 * Find the next item, and store that information.
+	 * Remove an item.
+	 * @param item The item to remove.
+	 * @pre this->Find(item) != NOT_FOUND
 	 */
-	void FindNext()
+	void Erase(int64 item)
 	{
-		if (this->bucket_list == nullptr) {
-			this->has_no_more_items = true;
-			return;
-		}
-
-		this->bucket_list_iter++;
-		if (this->bucket_list_iter == this->bucket_list->end()) {
-			this->bucket_iter++;
-			if (this->bucket_iter == this->list->buckets.end()) {
-				this->bucket_list = nullptr;
-				return;
-			}
-			this->bucket_list = &(*this->bucket_iter).second;
-			this->bucket_list_iter = this->bucket_list->begin();
+		size_t slot = this->FindSlot(item);
+		size_t index = this->slots[slot] - 1;
+		this->ClearSlot(slot);
+
+		/* Fill the hole in the entries with the last entry, so they stay dense. */
+		size_t last = this->entries.size() - 1;
+		if (index != last) {
+			this->entries[index] = this->entries[last];
+			this->slots[this->FindSlot(this->entries[index].item)] = (uint32)index + 1;
 		}
-		this->item_next = *this->bucket_list_iter;
-	}
-
-	int64 Next()
-	{
-		if (this->IsEnd()) return 0;
-
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+		this->entries.pop_back();
 	}
 
-	void Remove(int item)
+	/**
+	 * Remove all items.
+	 */
+	void Clear()
 	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
+		this->entries.clear();
+		this->slots.clear();
+		this->hash_shift = 64;
 	}
 };
 
 /**
- * Sort by value, descending.
+ * Sorter of a ScriptList. It keeps a copy of the items in ascending order,
+ * which is only rebuilt when an iteration is started after the list has
+ * been changed. Changes during an iteration are applied to that copy
+ * without resorting: removed items are marked as such, and added items
+ * (or items with a changed value) are kept in a small separate sorted
+ * list, which is merged into the copy once it grows too large.
  */
-class ScriptListSorterValueDescending : public ScriptListSorter {
+class ScriptListSorter {
 private:
-	/* Note: We cannot use reverse_iterator.
-	 *       The iterators must only be invalidated when the element they are pointing to is removed.
-	 *       This only holds for forward iterators. */
-	ScriptList::ScriptListBucket::iterator bucket_iter;    ///< The iterator over the list to find the buckets.
-	ScriptList::ScriptItemList *bucket_list;               ///< The current bucket list we're iterator over.
-	ScriptList::ScriptItemList::iterator bucket_list_iter; ///< The iterator over the bucket list.
+	ScriptList *list;              ///< The list that's being sorted.
+	ScriptListEntryLess less;      ///< The ordering of the items.
+	bool ascending;                ///< Whether to iterate in ascending order.
+	bool has_no_more_items;        ///< Whether we have more items to iterate over.
+	bool reached_end;              ///< Whether #item_next is the last item of the iteration.
+	ScriptListEntry item_next;     ///< The next item we will show, with its value at that time.
+
+	bool dirty;                    ///< Whether #sorted has to be rebuilt before use.
+	ScriptListEntryVector sorted;  ///< The items in ascending order.
+	std::vector<bool> sorted_gone; ///< For each entry in #sorted, whether it has been removed since.
+	size_t sorted_begin;           ///< Start of the range of #sorted that might contain entries that are not gone.
+	size_t sorted_end;             ///< End of the range of #sorted that might contain entries that are not gone.
+	size_t sorted_gone_count;      ///< Number of entries in #sorted that are gone.
+	ScriptListEntryVector added;   ///< Items added during the iteration, in ascending order.
+	std::vector<bool> added_gone;  ///< For each entry in #added, whether it has been removed since.
 
-public:
 	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
+	 * Find the first entry of a sorted vector that is not gone, in the given direction.
+	 * @param gone Whether each entry is gone.
+	 * @param begin Start of the range to search.
+	 * @param end End of the range to search.
+	 * @param forward Whether to search from the start of the range.
+	 * @return The index of the entry, or ScriptListItems::NOT_FOUND.
 	 */
-	ScriptListSorterValueDescending(ScriptList *list)
+	static size_t FindFirstIn(const std::vector<bool> &gone, size_t begin, size_t end, bool forward)
 	{
-		this->list = list;
-		this->End();
+		if (forward) {
+			for (size_t i = begin; i < end; i++) if (!gone[i]) return i;
+		} else {
+			for (size_t i = end; i > begin; i--) if (!gone[i - 1]) return i - 1;
+		}
+		return ScriptListItems::NOT_FOUND;
 	}
 
-	int64 Begin()
+	/**
+	 * Find the first entry of a sorted vector that is not gone and comes after the key, in the given direction.
+	 * @param entries The entries to search in.
+	 * @param gone Whether each entry is gone.
+	 * @param begin Start of the range to search.
+	 * @param end End of the range to search.
+	 * @param key The entry to search after.
+	 * @param forward Whether to search for higher (true) or lower (false) entries than the key.
+	 * @return The index of the entry, or ScriptListItems::NOT_FOUND.
+	 */
+	size_t FindAfterIn(const ScriptListEntryVector &entries, const std::vector<bool> &gone, size_t begin, size_t end, const ScriptListEntry &key, bool forward) const
 	{
-		if (this->list->buckets.empty()) return 0;
-		this->has_no_more_items = false;
-
-		/* Go to the end of the bucket-list */
-		this->bucket_iter = this->list->buckets.end();
-		--this->bucket_iter;
-		this->bucket_list = &(*this->bucket_iter).second;
+		if (forward) {
+			size_t i = std::upper_bound(entries.begin() + begin, entries.begin() + end, key, this->less) - entries.begin();
+			return FindFirstIn(gone, i, end, true);
+		}
+		size_t i = std::lower_bound(entries.begin() + begin, entries.begin() + end, key, this->less) - entries.begin();
+		return FindFirstIn(gone, begin, i, false);
+	}
 
-		/* Go to the end of the items in the bucket */
-		this->bucket_list_iter = this->bucket_list->end();
-		--this->bucket_list_iter;
-		this->item_next = *this->bucket_list_iter;
+	/**
+	 * Mark the entry equal to the given one as gone.
+	 * @param entries The entries to search in.
+	 * @param gone Whether each entry is gone.
+	 * @param begin Start of the range to search.
+	 * @param end End of the range to search.
+	 * @param entry The entry to mark.
+	 * @return True if the entry has been found.
+	 */
+	bool MarkGoneIn(const ScriptListEntryVector &entries, std::vector<bool> &gone, size_t begin, size_t end, const ScriptListEntry &entry) const
+	{
+		size_t i = std::lower_bound(entries.begin() + begin, entries.begin() + end, entry, this->less) - entries.begin();
+		for (; i < end && !this->less(entry, entries[i]); i++) {
+			if (gone[i]) continue;
+			gone[i] = true;
+			return true;
+		}
+		return false;
+	}
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+	/**
+	 * Choose which of the found candidates in #sorted and #added comes first.
+	 * @param sorted_index Index of the candidate in #sorted, or ScriptListItems::NOT_FOUND.
+	 * @param added_index Index of the candidate in #added, or ScriptListItems::NOT_FOUND.
+	 * @param forward Whether we are searching for the lowest (true) or highest (false) entry.
+	 * @param[out] result The chosen entry.
+	 * @return False if there was no candidate at all.
+	 */
+	bool Choose(size_t sorted_index, size_t added_index, bool forward, ScriptListEntry *result) const
+	{
+		if (sorted_index == ScriptListItems::NOT_FOUND && added_index == ScriptListItems::NOT_FOUND) return false;
+		if (sorted_index == ScriptListItems::NOT_FOUND) {
+			*result = this->added[added_index];
+		} else if (added_index == ScriptListItems::NOT_FOUND) {
+			*result = this->sorted[sorted_index];
+		} else {
+			const ScriptListEntry &a = this->sorted[sorted_index];
+			const ScriptListEntry &b = this->added[added_index];
+			*result = (this->less(a, b) == forward) ? a : b;
+		}
+		return true;
 	}
 
-	void End()
+	/**
+	 * Rebuild the sorted copy of the items when needed.
+	 */
+	void Rebuild()
 	{
-		this->bucket_list = nullptr;
-		this->has_no_more_items = true;
-		this->item_next = 0;
+		if (!this->dirty) return;
+
+		this->sorted = this->list->items->entries;
+		std::sort(this->sorted.begin(), this->sorted.end(), this->less);
+		this->sorted_gone.assign(this->sorted.size(), false);
+		this->sorted_begin = 0;
+		this->sorted_end = this->sorted.size();
+		this->sorted_gone_count = 0;
+		this->added.clear();
+		this->added_gone.clear();
+		this->dirty = false;
 	}
 
 	/**
-	 * Find the next item, and store that information.
+	 * Merge the added items into the sorted copy, dropping all entries that are gone.
 	 */
-	void FindNext()
+	void Merge()
 	{
-		if (this->bucket_list == nullptr) {
-			this->has_no_more_items = true;
-			return;
+		ScriptListEntryVector merged;
+		merged.reserve(this->list->items->entries.size());
+
+		size_t i = this->sorted_begin;
+		size_t j = 0;
+		for (;;) {
+			while (i < this->sorted_end && this->sorted_gone[i]) i++;
+			while (j < this->added.size() && this->added_gone[j]) j++;
+			if (i == this->sorted_end && j == this->added.size()) break;
+
+			if (j == this->added.size() || (i != this->sorted_end && this->less(this->sorted[i], this->added[j]))) {
+				merged.push_back(this->sorted[i++]);
+			} else {
+				merged.push_back(this->added[j++]);
+			}
 		}
 
-		if (this->bucket_list_iter == this->bucket_list->begin()) {
-			if (this->bucket_iter == this->list->buckets.begin()) {
-				this->bucket_list = nullptr;
-				return;
-			}
-			this->bucket_iter--;
-			this->bucket_list = &(*this->bucket_iter).second;
-			/* Go to the end of the items in the bucket */
-			this->bucket_list_iter = this->bucket_list->end();
-			--this->bucket_list_iter;
+		this->sorted.swap(merged);
+		this->sorted_gone.assign(this->sorted.size(), false);
+		this->sorted_begin = 0;
+		this->sorted_end = this->sorted.size();
+		this->sorted_gone_count = 0;
+		this->added.clear();
+		this->added_gone.clear();
+	}
+
+	/**
+	 * Find the first item in the given direction.
+	 * @param forward Whether to find the lowest (true) or highest (false) item.
+	 * @param[out] result The found item.
+	 * @return False if the list is empty.
+	 */
+	bool FindFirst(bool forward, ScriptListEntry *result)
+	{
+		this->Rebuild();
+
+		/* Skip the gone entries at the edge for good, so repeatedly taking the first item stays cheap. */
+		size_t sorted_index = FindFirstIn(this->sorted_gone, this->sorted_begin, this->sorted_end, forward);
+		if (sorted_index == ScriptListItems::NOT_FOUND) {
+			this->sorted_begin = this->sorted_end;
+		} else if (forward) {
+			this->sorted_begin = sorted_index;
 		} else {
-			this->bucket_list_iter--;
+			this->sorted_end = sorted_index + 1;
 		}
-		this->item_next = *this->bucket_list_iter;
+
+		size_t added_index = FindFirstIn(this->added_gone, 0, this->added.size(), forward);
+		return this->Choose(sorted_index, added_index, forward, result);
 	}
 
-	int64 Next()
+	/**
+	 * Find the item following the given one in the given direction.
+	 * @param key The item (with its value) to search after.
+	 * @param forward Whether to find the next higher (true) or lower (false) item.
+	 * @param[out] result The found item.
+	 * @return False if there is no such item.
+	 */
+	bool FindAfter(const ScriptListEntry &key, bool forward, ScriptListEntry *result)
 	{
-		if (this->IsEnd()) return 0;
+		this->Rebuild();
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+		size_t sorted_index = this->FindAfterIn(this->sorted, this->sorted_gone, this->sorted_begin, this->sorted_end, key, forward);
+		size_t added_index = this->FindAfterIn(this->added, this->added_gone, 0, this->added.size(), key, forward);
+		return this->Choose(sorted_index, added_index, forward, result);
 	}
 
-	void Remove(int item)
+	/**
+	 * Find the next item, and store that information.
+	 */
+	void FindNext()
 	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
+		if (this->reached_end) {
+			this->has_no_more_items = true;
 			return;
 		}
-	}
-};
 
-/**
- * Sort by item, ascending.
- */
-class ScriptListSorterItemAscending : public ScriptListSorter {
-private:
-	ScriptList::ScriptListMap::iterator item_iter; ///< The iterator over the items in the map.
+		if (!this->FindAfter(this->item_next, this->ascending, &this->item_next)) this->reached_end = true;
+	}
 
 public:
 	/**
 	 * Create a new sorter.
 	 * @param list The list to sort.
+	 * @param by_value Whether to sort on value, or on item.
+	 * @param ascending Whether to sort ascending.
 	 */
-	ScriptListSorterItemAscending(ScriptList *list)
+	ScriptListSorter(ScriptList *list, bool by_value, bool ascending) : list(list), ascending(ascending), dirty(true), sorted_begin(0), sorted_end(0), sorted_gone_count(0)
 	{
-		this->list = list;
+		this->less.by_value = by_value;
 		this->End();
 	}
 
+	/**
+	 * Change the ordering of the sorter. This stops the current iteration.
+	 * @param by_value Whether to sort on value, or on item.
+	 * @param ascending Whether to sort ascending.
+	 */
+	void SetOrder(bool by_value, bool ascending)
+	{
+		/* The sorted copy is ascending in both directions, so only a different key needs a rebuild. */
+		if (by_value != this->less.by_value) this->dirty = true;
+		this->less.by_value = by_value;
+		this->ascending = ascending;
+		this->End();
+	}
+
+	/**
+	 * Get the first item of the sorter.
+	 */
 	int64 Begin()
 	{
-		if (this->list->items.empty()) return 0;
+		if (this->list->IsEmpty()) return 0;
 		this->has_no_more_items = false;
+		this->reached_end = false;
+
+		/* Starting over is a good moment to drop the entries that are gone. */
+		if (!this->dirty && this->sorted_gone_count > this->sorted.size() / 2) this->Merge();
 
-		this->item_iter = this->list->items.begin();
-		this->item_next = (*this->item_iter).first;
+		bool found = this->FindFirst(this->ascending, &this->item_next);
+		assert(found);
 
-		int64 item_current = this->item_next;
+		int64 item_current = this->item_next.item;
 		FindNext();
 		return item_current;
 	}
 
+	/**
+	 * Stop iterating a sorter.
+	 */
 	void End()
 	{
 		this->has_no_more_items = true;
+		this->reached_end = true;
+		this->item_next.item = 0;
+		this->item_next.value = 0;
 	}
 
 	/**
-	 * Find the next item, and store that information.
+	 * Get the next item of the sorter.
 	 */
-	void FindNext()
-	{
-		if (this->item_iter == this->list->items.end()) {
-			this->has_no_more_items = true;
-			return;
-		}
-		this->item_iter++;
-		if (this->item_iter != this->list->items.end()) item_next = (*this->item_iter).first;
-	}
-
 	int64 Next()
 	{
 		if (this->IsEnd()) return 0;
 
-		int64 item_current = this->item_next;
+		int64 item_current = this->item_next.item;
 		FindNext();
 		return item_current;
 	}
 
-	void Remove(int item)
+	/**
+	 * See if the sorter has reached the end.
+	 */
+	bool IsEnd()
+	{
+		return this->list->IsEmpty() || this->has_no_more_items;
+	}
+
+	/**
+	 * Callback from the list if an item gets removed, or its value changed.
+	 * This is called before the list itself is changed.
+	 */
+	void Remove(int64 item)
 	{
 		if (this->IsEnd()) return;
 
 		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
+		if (item == this->item_next.item) {
 			FindNext();
 			return;
 		}
 	}
-};
-
-/**
- * Sort by item, descending.
- */
-class ScriptListSorterItemDescending : public ScriptListSorter {
-private:
-	/* Note: We cannot use reverse_iterator.
-	 *       The iterators must only be invalidated when the element they are pointing to is removed.
-	 *       This only holds for forward iterators. */
-	ScriptList::ScriptListMap::iterator item_iter; ///< The iterator over the items in the map.
 
-public:
 	/**
-	 * Create a new sorter.
-	 * @param list The list to sort.
+	 * Callback from the list after an item has been added.
+	 * @param entry The added item with its value.
 	 */
-	ScriptListSorterItemDescending(ScriptList *list)
+	void ItemAdded(const ScriptListEntry &entry)
 	{
-		this->list = list;
-		this->End();
+		if (this->dirty) return;
+
+		/* Without an iteration going on, a resort on the next Begin() is cheaper. */
+		if (this->has_no_more_items) {
+			this->dirty = true;
+			return;
+		}
+
+		size_t i = std::upper_bound(this->added.begin(), this->added.end(), entry, this->less) - this->added.begin();
+		this->added.insert(this->added.begin() + i, entry);
+		this->added_gone.insert(this->added_gone.begin() + i, false);
+
+		/* Inserting costs linear time in the number of added items, so merge them once there are too many. */
+		if (this->added.size() > 32 && this->added.size() * this->added.size() > this->sorted.size()) this->Merge();
 	}
 
-	int64 Begin()
+	/**
+	 * Callback from the list after an item has been removed.
+	 * @param entry The removed item with its value.
+	 */
+	void ItemRemoved(const ScriptListEntry &entry)
 	{
-		if (this->list->items.empty()) return 0;
-		this->has_no_more_items = false;
+		if (this->dirty) return;
 
-		this->item_iter = this->list->items.end();
-		--this->item_iter;
-		this->item_next = (*this->item_iter).first;
+		if (this->has_no_more_items) {
+			this->dirty = true;
+			return;
+		}
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+		if (this->MarkGoneIn(this->sorted, this->sorted_gone, this->sorted_begin, this->sorted_end, entry)) {
+			this->sorted_gone_count++;
+			return;
+		}
+		bool found = this->MarkGoneIn(this->added, this->added_gone, 0, this->added.size(), entry);
+		assert(found);
 	}
 
-	void End()
+	/**
+	 * Callback from the list after the value of an item has been changed.
+	 * @param item The item.
+	 * @param old_value The value the item had.
+	 * @param new_value The value the item has now.
+	 */
+	void ValueChanged(int64 item, int64 old_value, int64 new_value)
 	{
-		this->has_no_more_items = true;
+		/* The position of an item only depends on its value when sorting by value. */
+		if (!this->less.by_value) return;
+
+		this->ItemRemoved({item, old_value});
+		this->ItemAdded({item, new_value});
 	}
 
 	/**
-	 * Find the next item, and store that information.
+	 * Callback from the list after it has been changed in bulk.
 	 */
-	void FindNext()
+	void Invalidate()
 	{
-		if (this->item_iter == this->list->items.end()) {
-			this->has_no_more_items = true;
-			return;
-		}
-		if (this->item_iter == this->list->items.begin()) {
-			/* Use 'end' as marker for 'beyond begin' */
-			this->item_iter = this->list->items.end();
-		} else {
-			this->item_iter--;
-		}
-		if (this->item_iter != this->list->items.end()) item_next = (*this->item_iter).first;
+		this->dirty = true;
 	}
 
-	int64 Next()
+	/**
+	 * Get the items at the start or end of the iteration order, without disturbing the iteration.
+	 * @param count The number of items to get.
+	 * @param front Whether to take the items from the start.
+	 * @param[out] items The items, in the order seen from the chosen edge.
+	 */
+	void GetEdgeItems(int32 count, bool front, std::vector<int64> *items)
 	{
-		if (this->IsEnd()) return 0;
+		bool forward = (front == this->ascending);
+		ScriptListEntry entry;
+		if (count <= 0 || !this->FindFirst(forward, &entry)) return;
 
-		int64 item_current = this->item_next;
-		FindNext();
-		return item_current;
+		do {
+			items->push_back(entry.item);
+		} while (--count > 0 && this->FindAfter(entry, forward, &entry));
 	}
 
-	void Remove(int item)
+	/**
+	 * Attach the sorter to a new list. This assumes the content of the old list has been moved to
+	 * the new list, too, so that the sorted copy is still valid.
+	 * @param target New list to attach to.
+	 */
+	void Retarget(ScriptList *new_list)
 	{
-		if (this->IsEnd()) return;
-
-		/* If we remove the 'next' item, skip to the next */
-		if (item == this->item_next) {
-			FindNext();
-			return;
-		}
+		this->list = new_list;
 	}
 };
 
+/**
+ * Get the entries of a list in ascending order of the items. This is the
+ * order in which lists are walked when valuating or combining them.
+ * @param list The list to get the entries of.
+ * @return The sorted entries.
+ */
+static ScriptListEntryVector GetEntriesByItem(const ScriptList *list)
+{
+	ScriptListEntryVector entries = list->items->entries;
+	std::sort(entries.begin(), entries.end(), ScriptListEntryLess{false});
+	return entries;
+}
 
 
 ScriptList::ScriptList()
 {
+	this->items          = new ScriptListItems();
 	/* Default sorter */
-	this->sorter         = new ScriptListSorterValueDescending(this);
+	this->sorter         = new ScriptListSorter(this, true, false);
 	this->sorter_type    = SORT_BY_VALUE;
 	this->sort_ascending = false;
 	this->initialized    = false;
@@ -417,47 +599,44 @@ ScriptList::ScriptList()
 ScriptList::~ScriptList()
 {
 	delete this->sorter;
+	delete this->items;
 }
 
 bool ScriptList::HasItem(int64 item)
 {
-	return this->items.count(item) == 1;
+	return this->items->Find(item) != ScriptListItems::NOT_FOUND;
 }
 
 void ScriptList::Clear()
 {
 	this->modifications++;
 
-	this->items.clear();
-	this->buckets.clear();
+	this->items->Clear();
 	this->sorter->End();
+	this->sorter->Invalidate();
 }
 
 void ScriptList::AddItem(int64 item, int64 value)
 {
 	this->modifications++;
 
-	if (this->HasItem(item)) return;
+	if (!this->items->Insert(item, value)) return;
 
-	this->items[item] = value;
-	this->buckets[value].insert(item);
+	this->sorter->ItemAdded({item, value});
 }
 
 void ScriptList::RemoveItem(int64 item)
 {
 	this->modifications++;
 
-	ScriptListMap::iterator item_iter = this->items.find(item);
-	if (item_iter == this->items.end()) return;
+	size_t index = this->items->Find(item);
+	if (index == ScriptListItems::NOT_FOUND) return;
 
-	int64 value = item_iter->second;
+	ScriptListEntry entry = this->items->entries[index];
 
 	this->sorter->Remove(item);
-	ScriptListBucket::iterator bucket_iter = this->buckets.find(value);
-	assert(bucket_iter != this->buckets.end());
-	bucket_iter->second.erase(item);
-	if (bucket_iter->second.empty()) this->buckets.erase(bucket_iter);
-	this->items.erase(item_iter);
+	this->items->Erase(item);
+	this->sorter->ItemRemoved(entry);
 }
 
 int64 ScriptList::Begin()
@@ -477,7 +656,7 @@ int64 ScriptList::Next()
 
 bool ScriptList::IsEmpty()
 {
-	return this->items.empty();
+	return this->items->entries.empty();
 }
 
 bool ScriptList::IsEnd()
@@ -491,32 +670,28 @@ bool ScriptList::IsEnd()
 
 int32 ScriptList::Count()
 {
-	return (int32)this->items.size();
+	return (int32)this->items->entries.size();
 }
 
 int64 ScriptList::GetValue(int64 item)
 {
-	ScriptListMap::const_iterator item_iter = this->items.find(item);
-	return item_iter == this->items.end() ? 0 : item_iter->second;
+	size_t index = this->items->Find(item);
+	return index == ScriptListItems::NOT_FOUND ? 0 : this->items->entries[index].value;
 }
 
 bool ScriptList::SetValue(int64 item, int64 value)
 {
 	this->modifications++;
 
-	ScriptListMap::iterator item_iter = this->items.find(item);
-	if (item_iter == this->items.end()) return false;
+	size_t index = this->items->Find(item);
+	if (index == ScriptListItems::NOT_FOUND) return false;
 
-	int64 value_old = item_iter->second;
+	int64 value_old = this->items->entries[index].value;
 	if (value_old == value) return true;
 
 	this->sorter->Remove(item);
-	ScriptListBucket::iterator bucket_iter = this->buckets.find(value_old);
-	assert(bucket_iter != this->buckets.end());
-	bucket_iter->second.erase(item);
-	if (bucket_iter->second.empty()) this->buckets.erase(bucket_iter);
-	item_iter->second = value;
-	this->buckets[value].insert(item);
+	this->items->entries[index].value = value;
+	this->sorter->ValueChanged(item, value_old, value);
 
 	return true;
 }
@@ -528,26 +703,7 @@ void ScriptList::Sort(SorterType sorter, bool ascending)
 	if (sorter != SORT_BY_VALUE && sorter != SORT_BY_ITEM) return;
 	if (sorter == this->sorter_type && ascending == this->sort_ascending) return;
 
-	delete this->sorter;
-	switch (sorter) {
-		case SORT_BY_ITEM:
-			if (ascending) {
-				this->sorter = new ScriptListSorterItemAscending(this);
-			} else {
-				this->sorter = new ScriptListSorterItemDescending(this);
-			}
-			break;
-
-		case SORT_BY_VALUE:
-			if (ascending) {
-				this->sorter = new ScriptListSorterValueAscending(this);
-			} else {
-				this->sorter = new ScriptListSorterValueDescending(this);
-			}
-			break;
-
-		default: NOT_REACHED();
-	}
+	this->sorter->SetOrder(sorter == SORT_BY_VALUE, ascending);
 	this->sorter_type    = sorter;
 	this->sort_ascending = ascending;
 	this->initialized    = false;
@@ -559,14 +715,13 @@ void ScriptList::AddList(ScriptList *list)
 
 	if (this->IsEmpty()) {
 		/* If this is empty, we can just take the items of the other list as is. */
-		this->items = list->items;
-		this->buckets = list->buckets;
+		*this->items = *list->items;
+		this->sorter->Invalidate();
 		this->modifications++;
 	} else {
-		ScriptListMap *list_items = &list->items;
-		for (ScriptListMap::iterator iter = list_items->begin(); iter != list_items->end(); iter++) {
-			this->AddItem((*iter).first);
-			this->SetValue((*iter).first, (*iter).second);
+		for (const ScriptListEntry &entry : GetEntriesByItem(list)) {
+			this->AddItem(entry.item);
+			this->SetValue(entry.item, entry.value);
 		}
 	}
 }
@@ -575,8 +730,7 @@ void ScriptList::SwapList(ScriptList *list)
 {
 	if (list == this) return;
 
-	this->items.swap(list->items);
-	this->buckets.swap(list->buckets);
+	Swap(this->items, list->items);
 	Swap(this->sorter, list->sorter);
 	Swap(this->sorter_type, list->sorter_type);
 	Swap(this->sort_ascending, list->sort_ascending);
@@ -586,44 +740,50 @@ void ScriptList::SwapList(ScriptList *list)
 	list->sorter->Retarget(list);
 }
 
+/**
+ * Remove all items of which the value matches, in ascending order of the
+ * items. That order matters for where a running iteration continues.
+ * @param list The list to remove the items from.
+ * @param matches Predicate on the value of an item.
+ */
+template <typename Tmatches>
+static void RemoveMatchingValues(ScriptList *list, Tmatches matches)
+{
+	std::vector<int64> remove;
+	for (const ScriptListEntry &entry : list->items->entries) {
+		if (matches(entry.value)) remove.push_back(entry.item);
+	}
+	std::sort(remove.begin(), remove.end());
+
+	for (int64 item : remove) list->RemoveItem(item);
+}
+
 void ScriptList::RemoveAboveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second > value) this->RemoveItem((*iter).first);
-	}
+	RemoveMatchingValues(this, [&](int64 item_value) { return item_value > value; });
 }
 
 void ScriptList::RemoveBelowValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second < value) this->RemoveItem((*iter).first);
-	}
+	RemoveMatchingValues(this, [&](int64 item_value) { return item_value < value; });
 }
 
 void ScriptList::RemoveBetweenValue(int64 start, int64 end)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second > start && (*iter).second < end) this->RemoveItem((*iter).first);
-	}
+	RemoveMatchingValues(this, [&](int64 item_value) { return item_value > start && item_value < end; });
 }
 
 void ScriptList::RemoveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second == value) this->RemoveItem((*iter).first);
-	}
+	RemoveMatchingValues(this, [&](int64 item_value) { return item_value == value; });
 }
 
 void ScriptList::RemoveTop(int32 count)
@@ -637,30 +797,9 @@ void ScriptList::RemoveTop(int32 count)
 		return;
 	}
 
-	switch (this->sorter_type) {
-		default: NOT_REACHED();
-		case SORT_BY_VALUE:
-			for (ScriptListBucket::iterator iter = this->buckets.begin(); iter != this->buckets.end(); iter = this->buckets.begin()) {
-				ScriptItemList *items = &(*iter).second;
-				size_t size = items->size();
-				for (ScriptItemList::iterator iter = items->begin(); iter != items->end(); iter = items->begin()) {
-					if (--count < 0) return;
-					this->RemoveItem(*iter);
-					/* When the last item is removed from the bucket, the bucket itself is removed.
-					 * This means that the iterators can be invalid after a call to RemoveItem.
-					 */
-					if (--size == 0) break;
-				}
-			}
-			break;
-
-		case SORT_BY_ITEM:
-			for (ScriptListMap::iterator iter = this->items.begin(); iter != this->items.end(); iter = this->items.begin()) {
-				if (--count < 0) return;
-				this->RemoveItem((*iter).first);
-			}
-			break;
-	}
+	std::vector<int64> remove;
+	this->sorter->GetEdgeItems(count, true, &remove);
+	for (int64 item : remove) this->RemoveItem(item);
 }
 
 void ScriptList::RemoveBottom(int32 count)
@@ -674,30 +813,9 @@ void ScriptList::RemoveBottom(int32 count)
 		return;
 	}
 
-	switch (this->sorter_type) {
-		default: NOT_REACHED();
-		case SORT_BY_VALUE:
-			for (ScriptListBucket::reverse_iterator iter = this->buckets.rbegin(); iter != this->buckets.rend(); iter = this->buckets.rbegin()) {
-				ScriptItemList *items = &(*iter).second;
-				size_t size = items->size();
-				for (ScriptItemList::reverse_iterator iter = items->rbegin(); iter != items->rend(); iter = items->rbegin()) {
-					if (--count < 0) return;
-					this->RemoveItem(*iter);
-					/* When the last item is removed from the bucket, the bucket itself is removed.
-					 * This means that the iterators can be invalid after a call to RemoveItem.
-					 */
-					if (--size == 0) break;
-				}
-			}
-			break;
-
-		case SORT_BY_ITEM:
-			for (ScriptListMap::reverse_iterator iter = this->items.rbegin(); iter != this->items.rend(); iter = this->items.rbegin()) {
-				if (--count < 0) return;
-				this->RemoveItem((*iter).first);
-			}
-			break;
-	}
+	std::vector<int64> remove;
+	this->sorter->GetEdgeItems(count, false, &remove);
+	for (int64 item : remove) this->RemoveItem(item);
 }
 
 void ScriptList::RemoveList(ScriptList *list)
@@ -707,9 +825,8 @@ void ScriptList::RemoveList(ScriptList *list)
 	if (list == this) {
 		Clear();
 	} else {
-		ScriptListMap *list_items = &list->items;
-		for (ScriptListMap::iterator iter = list_items->begin(); iter != list_items->end(); iter++) {
-			this->RemoveItem((*iter).first);
+		for (const ScriptListEntry &entry : GetEntriesByItem(list)) {
+			this->RemoveItem(entry.item);
 		}
 	}
 }
@@ -718,40 +835,28 @@ void ScriptList::KeepAboveValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second <= value) this->RemoveItem((*iter).first);
-	}
+	RemoveMatchingValues(this, [&](int64 item_value) { return item_value <= value; });
 }
 
 void ScriptList::KeepBelowValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second >= value) this->RemoveItem((*iter).first);
-	}
+	RemoveMatchingValues(this, [&](int64 item_value) { return item_value >= value; });
 }
 
 void ScriptList::KeepBetweenValue(int64 start, int64 end)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second <= start || (*iter).second >= end) this->RemoveItem((*iter).first);
-	}
+	RemoveMatchingValues(this, [&](int64 item_value) { return item_value <= start || item_value >= end; });
 }
 
 void ScriptList::KeepValue(int64 value)
 {
 	this->modifications++;
 
-	for (ScriptListMap::iterator next_iter, iter = this->items.begin(); iter != this->items.end(); iter = next_iter) {
-		next_iter = iter; next_iter++;
-		if ((*iter).second != value) this->RemoveItem((*iter).first);
-	}
+	RemoveMatchingValues(this, [&](int64 item_value) { return item_value != value; });
 }
 
 void ScriptList::KeepTop(int32 count)
@@ -787,10 +892,10 @@ SQInteger ScriptList::_get(HSQUIRRELVM vm)
 	SQInteger idx;
 	sq_getinteger(vm, 2, &idx);
 
-	ScriptListMap::const_iterator item_iter = this->items.find(idx);
-	if (item_iter == this->items.end()) return SQ_ERROR;
+	size_t index = this->items->Find(idx);
+	if (index == ScriptListItems::NOT_FOUND) return SQ_ERROR;
 
-	sq_pushinteger(vm, item_iter->second);
+	sq_pushinteger(vm, this->items->entries[index].value);
 	return 1;
 }
 
@@ -842,6 +947,19 @@ SQInteger ScriptList::_nexti(HSQUIRRELVM vm)
 	return 1;
 }
 
+void ScriptList::ValuateNative(NativeValuator *valuator, const void *data)
+{
+	this->modifications++;
+
+	ScriptListEntryVector entries = GetEntriesByItem(this);
+	for (const ScriptListEntry &entry : entries) {
+		this->SetValue(entry.item, valuator(entry.item, data));
+	}
+
+	/* Still charge the script for the work, just (much) less than a Squirrel valuator costs. */
+	ScriptObject::GetActiveInstance()->DecreaseOps((int)entries.size());
+}
+
 SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 {
 	this->modifications++;
@@ -869,20 +987,27 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 	/* Push the function to call */
 	sq_push(vm, 2);
 
-	for (ScriptListMap::iterator iter = this->items.begin(); iter != this->items.end(); iter++) {
+	for (const ScriptListEntry &entry : GetEntriesByItem(this)) {
 		/* Check for changing of items. */
 		int previous_modification_count = this->modifications;
 
 		/* Push the root table as instance object, this is what squirrel does for meta-functions. */
 		sq_pushroottable(vm);
 		/* Push all arguments for the valuator function. */
-		sq_pushinteger(vm, (*iter).first);
+		sq_pushinteger(vm, entry.item);
 		for (int i = 0; i < nparam - 1; i++) {
 			sq_push(vm, i + 3);
 		}
 
-		/* Call the function. Squirrel pops all parameters and pushes the return value. */
-		if (SQ_FAILED(sq_call(vm, nparam + 1, SQTrue, SQTrue))) {
+		/* Call the function. Squirrel pops all parameters and pushes the return value.
+		 * The valuator only touches the game state through native calls of its own, so
+		 * other scripts may run native code while it runs. */
+		SQRESULT res;
+		{
+			ScriptNativeCallbackScope callback_scope;
+			res = sq_call(vm, nparam + 1, SQTrue, SQTrue);
+		}
+		if (SQ_FAILED(res)) {
 			ScriptObject::SetAllowDoCommand(backup_allow);
 			return SQ_ERROR;
 		}
@@ -930,7 +1055,7 @@ SQInteger ScriptList::Valuate(HSQUIRRELVM vm)
 			return sq_throwerror(vm, "modifying valuated list outside of valuator function");
 		}
 
-		this->SetValue((*iter).first, value);
+		this->SetValue(entry.item, value);
 
 		/* Pop the return value. */
 		sq_poptop(vm);
@@ -12,10 +12,9 @@
 #define SCRIPT_LIST_HPP
 
 #include "script_object.hpp"
-#include <map>
-#include <set>
 
 class ScriptListSorter;
+class ScriptListItems;
 
 /**
  * Class that creates a list which can keep item/value pairs, which you can walk.
@@ -42,12 +41,7 @@ private:
 	int modifications;            ///< Number of modification that has been done. To prevent changing data while valuating.
 
 public:
-	typedef std::set<int64> ScriptItemList;                   ///< The list of items inside the bucket
-	typedef std::map<int64, ScriptItemList> ScriptListBucket; ///< The bucket list per value
-	typedef std::map<int64, int64> ScriptListMap;             ///< List per item
-
-	ScriptListMap items;           ///< The items in the list
-	ScriptListBucket buckets;      ///< The items in the list, sorted by value
+	ScriptListItems *items;       ///< The items in the list, with their values
 
 	ScriptList();
 	~ScriptList();
@@ -286,6 +280,24 @@ public:
 	 */
 	void Valuate(void *valuator_function, int params, ...);
 #endif /* DOXYGEN_API */
+
+protected:
+	/**
+	 * A valuator that is evaluated in C++ instead of Squirrel.
+	 * @param item The item to get the value of.
+	 * @param data The valuator specific data given to ValuateNative().
+	 * @return The value of the item.
+	 */
+	typedef int64 NativeValuator(int64 item, const void *data);
+
+	/**
+	 * Give all items a value defined by a native valuator. This gives the
+	 *  same result as Valuate() with the equivalent API function, but it
+	 *  does not call back into Squirrel for every item.
+	 * @param valuator The function which will be doing the valuation.
+	 * @param data Valuator specific data, passed on with every item.
+	 */
+	void ValuateNative(NativeValuator *valuator, const void *data = nullptr);
 };
 
 #endif /* SCRIPT_LIST_HPP */
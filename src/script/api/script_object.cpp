@@ -35,7 +35,7 @@ static ScriptStorage *GetStorage()
 }
 
 
-/* static */ ScriptInstance *ScriptObject::ActiveInstance::active = nullptr;
+/* static */ thread_local ScriptInstance *ScriptObject::ActiveInstance::active = nullptr;
 
 ScriptObject::ActiveInstance::ActiveInstance(ScriptInstance *instance) : alc_scope(instance->engine)
 {
@@ -279,6 +279,11 @@ ScriptObject::ActiveInstance::~ActiveInstance()
 	return GetStorage()->log_data;
 }
 
+/* static */ Randomizer &ScriptObject::GetThreadedRandom()
+{
+	return GetStorage()->threaded_random;
+}
+
 /* static */ char *ScriptObject::GetString(StringID string)
 {
 	char buffer[64];
@@ -321,14 +326,17 @@ ScriptObject::ActiveInstance::~ActiveInstance()
 	/* Are we only interested in the estimate costs? */
 	bool estimate_only = GetDoCommandMode() != nullptr && !GetDoCommandMode()();
 
+	/* Should the command only be tested now, and executed after all scripts ran? */
+	bool queue = !estimate_only && GetActiveInstance()->queue_commands;
+
 	/* Only set p2 when the command does not come from the network. */
 	if (GetCommandFlags(cmd) & CMD_CLIENT_ID && p2 == 0) p2 = UINT32_MAX;
 
 	/* Store the command for command callback validation. */
-	if (!estimate_only && _networking && !_generating_world) SetLastCommand(tile, p1, p2, cmd);
+	if (!estimate_only && (_networking || queue) && !_generating_world) SetLastCommand(tile, p1, p2, cmd);
 
 	/* Try to perform the command. */
-	CommandCost res = ::DoCommandPInternal(tile, p1, p2, cmd, (_networking && !_generating_world) ? ScriptObject::GetActiveInstance()->GetDoCommandCallback() : nullptr, text, false, estimate_only);
+	CommandCost res = ::DoCommandPInternal(tile, p1, p2, cmd, (_networking && !_generating_world) ? ScriptObject::GetActiveInstance()->GetDoCommandCallback() : nullptr, text, false, estimate_only || queue);
 
 	/* We failed; set the error and bail out */
 	if (res.Failed()) {
@@ -358,7 +366,9 @@ ScriptObject::ActiveInstance::~ActiveInstance()
 			throw SQInteger(1);
 		}
 		return true;
-	} else if (_networking) {
+	} else if (_networking || queue) {
+		if (queue) GetActiveInstance()->QueueCommand(tile, p1, p2, cmd, text);
+
 		/* Suspend the script till the command is really executed. */
 		throw Script_Suspend(-(int)GetDoCommandDelay(), callback);
 	} else {
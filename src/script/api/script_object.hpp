@@ -13,6 +13,7 @@
 #include "../../misc/countedptr.hpp"
 #include "../../road_type.h"
 #include "../../rail_type.h"
+#include "../../core/random_func.hpp"
 
 #include "script_types.hpp"
 #include "../script_suspend.hpp"
@@ -49,7 +50,7 @@ protected:
 		ScriptInstance *last_active;    ///< The active instance before we go instantiated.
 		ScriptAllocatorScope alc_scope; ///< Keep the correct allocator for the script instance activated
 
-		static ScriptInstance *active;  ///< The global current active instance.
+		static thread_local ScriptInstance *active; ///< The current active instance of this thread.
 	};
 
 public:
@@ -262,6 +263,13 @@ protected:
 	 */
 	static char *GetString(StringID string);
 
+	/**
+	 * Get the random the script draws from while it runs on a worker thread.
+	 * The order in which the scripts draw is not fixed then, so every script
+	 * has its own random, seeded from the game's random by the main thread.
+	 */
+	static Randomizer &GetThreadedRandom();
+
 private:
 	/**
 	 * Store a new_vehicle_id per company.
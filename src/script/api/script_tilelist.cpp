@@ -10,6 +10,7 @@
 #include "../../stdafx.h"
 #include "script_tilelist.hpp"
 #include "script_industry.hpp"
+#include "script_tile.hpp"
 #include "../../industry.h"
 #include "../../station_base.h"
 
@@ -47,6 +48,66 @@ void ScriptTileList::RemoveTile(TileIndex tile)
 	this->RemoveItem(tile);
 }
 
+/** Parameters of the ScriptTile::GetCargoAcceptance() valuator. */
+struct CargoAcceptanceValuatorData {
+	CargoID cargo_type; ///< The cargo to check the acceptance of.
+	int width;          ///< The width of the station.
+	int height;         ///< The height of the station.
+	int radius;         ///< The radius of the station.
+};
+
+static int64 SlopeValuator(int64 tile, const void *data)
+{
+	return ScriptTile::GetSlope((TileIndex)tile);
+}
+
+static int64 BuildableValuator(int64 tile, const void *data)
+{
+	return ScriptTile::IsBuildable((TileIndex)tile) ? 1 : 0;
+}
+
+static int64 DistanceManhattanValuator(int64 tile, const void *data)
+{
+	return ScriptTile::GetDistanceManhattanToTile((TileIndex)tile, *(const TileIndex *)data);
+}
+
+static int64 DistanceSquareValuator(int64 tile, const void *data)
+{
+	return ScriptTile::GetDistanceSquareToTile((TileIndex)tile, *(const TileIndex *)data);
+}
+
+static int64 CargoAcceptanceValuator(int64 tile, const void *data)
+{
+	const CargoAcceptanceValuatorData *d = (const CargoAcceptanceValuatorData *)data;
+	return ScriptTile::GetCargoAcceptance((TileIndex)tile, d->cargo_type, d->width, d->height, d->radius);
+}
+
+void ScriptTileList::ValuateSlope()
+{
+	this->ValuateNative(&SlopeValuator);
+}
+
+void ScriptTileList::ValuateBuildable()
+{
+	this->ValuateNative(&BuildableValuator);
+}
+
+void ScriptTileList::ValuateDistanceManhattanToTile(TileIndex tile)
+{
+	this->ValuateNative(&DistanceManhattanValuator, &tile);
+}
+
+void ScriptTileList::ValuateDistanceSquareToTile(TileIndex tile)
+{
+	this->ValuateNative(&DistanceSquareValuator, &tile);
+}
+
+void ScriptTileList::ValuateCargoAcceptance(CargoID cargo_type, int width, int height, int radius)
+{
+	CargoAcceptanceValuatorData data = { cargo_type, width, height, radius };
+	this->ValuateNative(&CargoAcceptanceValuator, &data);
+}
+
 /**
  * Helper to get list of tiles that will cover an industry's production or acceptance.
  * @param i Industry in question
@@ -51,6 +51,48 @@ public:
 	 * @pre ScriptMap::IsValidTile(tile).
 	 */
 	void RemoveTile(TileIndex tile);
+
+	/**
+	 * Give all tiles their slope as value.
+	 * @note This gives the same result as Valuate(ScriptTile.GetSlope), but
+	 *  it is a lot faster for large lists.
+	 */
+	void ValuateSlope();
+
+	/**
+	 * Give all tiles a value of 1 when they are buildable, otherwise 0.
+	 * @note This gives the same result as Valuate(ScriptTile.IsBuildable), but
+	 *  it is a lot faster for large lists.
+	 */
+	void ValuateBuildable();
+
+	/**
+	 * Give all tiles their manhattan distance to the given tile as value.
+	 * @param tile The tile to get the distance to.
+	 * @note This gives the same result as Valuate(ScriptTile.GetDistanceManhattanToTile, tile),
+	 *  but it is a lot faster for large lists.
+	 */
+	void ValuateDistanceManhattanToTile(TileIndex tile);
+
+	/**
+	 * Give all tiles their square distance to the given tile as value.
+	 * @param tile The tile to get the distance to.
+	 * @note This gives the same result as Valuate(ScriptTile.GetDistanceSquareToTile, tile),
+	 *  but it is a lot faster for large lists.
+	 */
+	void ValuateDistanceSquareToTile(TileIndex tile);
+
+	/**
+	 * Give all tiles the acceptance of the given cargo around them as value.
+	 * @param cargo_type The cargo to check the acceptance of.
+	 * @param width The width of the station.
+	 * @param height The height of the station.
+	 * @param radius The radius of the station.
+	 * @note This gives the same result as Valuate(ScriptTile.GetCargoAcceptance, cargo_type, width, height, radius),
+	 *  but it is a lot faster for large lists.
+	 * @see ScriptTile::GetCargoAcceptance
+	 */
+	void ValuateCargoAcceptance(CargoID cargo_type, int width, int height, int radius);
 };
 
 /**
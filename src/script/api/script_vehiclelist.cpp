@@ -18,14 +18,60 @@
 
 #include "../../safeguards.h"
 
-ScriptVehicleList::ScriptVehicleList()
+ScriptVehicleList::ScriptVehicleList() : ScriptVehicleList(true)
 {
+}
+
+ScriptVehicleList::ScriptVehicleList(bool fill)
+{
+	if (!fill) return;
+
 	for (const Vehicle *v : Vehicle::Iterate()) {
 		if ((v->owner == ScriptObject::GetCompany() || ScriptObject::GetCompany() == OWNER_DEITY) && (v->IsPrimaryVehicle() || (v->type == VEH_TRAIN && ::Train::From(v)->IsFreeWagon()))) this->AddItem(v->index);
 	}
 }
 
-ScriptVehicleList_Station::ScriptVehicleList_Station(StationID station_id)
+static int64 ProfitThisYearValuator(int64 vehicle_id, const void *data)
+{
+	return ScriptVehicle::GetProfitThisYear((VehicleID)vehicle_id);
+}
+
+static int64 ProfitLastYearValuator(int64 vehicle_id, const void *data)
+{
+	return ScriptVehicle::GetProfitLastYear((VehicleID)vehicle_id);
+}
+
+static int64 AgeValuator(int64 vehicle_id, const void *data)
+{
+	return ScriptVehicle::GetAge((VehicleID)vehicle_id);
+}
+
+static int64 StateValuator(int64 vehicle_id, const void *data)
+{
+	return ScriptVehicle::GetState((VehicleID)vehicle_id);
+}
+
+void ScriptVehicleList::ValuateProfitThisYear()
+{
+	this->ValuateNative(&ProfitThisYearValuator);
+}
+
+void ScriptVehicleList::ValuateProfitLastYear()
+{
+	this->ValuateNative(&ProfitLastYearValuator);
+}
+
+void ScriptVehicleList::ValuateAge()
+{
+	this->ValuateNative(&AgeValuator);
+}
+
+void ScriptVehicleList::ValuateState()
+{
+	this->ValuateNative(&StateValuator);
+}
+
+ScriptVehicleList_Station::ScriptVehicleList_Station(StationID station_id) : ScriptVehicleList(false)
 {
 	if (!ScriptBaseStation::IsValidBaseStation(station_id)) return;
 
@@ -43,7 +89,7 @@ ScriptVehicleList_Station::ScriptVehicleList_Station(StationID station_id)
 	}
 }
 
-ScriptVehicleList_Depot::ScriptVehicleList_Depot(TileIndex tile)
+ScriptVehicleList_Depot::ScriptVehicleList_Depot(TileIndex tile) : ScriptVehicleList(false)
 {
 	if (!ScriptMap::IsValidTile(tile)) return;
 
@@ -93,7 +139,7 @@ ScriptVehicleList_Depot::ScriptVehicleList_Depot(TileIndex tile)
 	}
 }
 
-ScriptVehicleList_SharedOrders::ScriptVehicleList_SharedOrders(VehicleID vehicle_id)
+ScriptVehicleList_SharedOrders::ScriptVehicleList_SharedOrders(VehicleID vehicle_id) : ScriptVehicleList(false)
 {
 	if (!ScriptVehicle::IsValidVehicle(vehicle_id)) return;
 
@@ -102,7 +148,7 @@ ScriptVehicleList_SharedOrders::ScriptVehicleList_SharedOrders(VehicleID vehicle
 	}
 }
 
-ScriptVehicleList_Group::ScriptVehicleList_Group(GroupID group_id)
+ScriptVehicleList_Group::ScriptVehicleList_Group(GroupID group_id) : ScriptVehicleList(false)
 {
 	if (!ScriptGroup::IsValidGroup((ScriptGroup::GroupID)group_id)) return;
 
@@ -113,7 +159,7 @@ ScriptVehicleList_Group::ScriptVehicleList_Group(GroupID group_id)
 	}
 }
 
-ScriptVehicleList_DefaultGroup::ScriptVehicleList_DefaultGroup(ScriptVehicle::VehicleType vehicle_type)
+ScriptVehicleList_DefaultGroup::ScriptVehicleList_DefaultGroup(ScriptVehicle::VehicleType vehicle_type) : ScriptVehicleList(false)
 {
 	if (vehicle_type < ScriptVehicle::VT_RAIL || vehicle_type > ScriptVehicle::VT_AIR) return;
 
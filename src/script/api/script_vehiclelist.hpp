@@ -21,6 +21,40 @@
 class ScriptVehicleList : public ScriptList {
 public:
 	ScriptVehicleList();
+
+	/**
+	 * Give all vehicles their profit of this year as value.
+	 * @note This gives the same result as Valuate(ScriptVehicle.GetProfitThisYear), but
+	 *  it is a lot faster for large lists.
+	 */
+	void ValuateProfitThisYear();
+
+	/**
+	 * Give all vehicles their profit of last year as value.
+	 * @note This gives the same result as Valuate(ScriptVehicle.GetProfitLastYear), but
+	 *  it is a lot faster for large lists.
+	 */
+	void ValuateProfitLastYear();
+
+	/**
+	 * Give all vehicles their age as value.
+	 * @note This gives the same result as Valuate(ScriptVehicle.GetAge), but
+	 *  it is a lot faster for large lists.
+	 */
+	void ValuateAge();
+
+	/**
+	 * Give all vehicles their state as value.
+	 * @note This gives the same result as Valuate(ScriptVehicle.GetState), but
+	 *  it is a lot faster for large lists.
+	 */
+	void ValuateState();
+
+protected:
+	/**
+	 * @param fill Whether to add all vehicles, or to leave the list empty for a subclass to fill.
+	 */
+	ScriptVehicleList(bool fill);
 };
 
 /**
@@ -28,7 +62,7 @@ public:
  * @api ai game
  * @ingroup ScriptList
  */
-class ScriptVehicleList_Station : public ScriptList {
+class ScriptVehicleList_Station : public ScriptVehicleList {
 public:
 	/**
 	 * @param station_id The station to get the list of vehicles from, which have orders to it.
@@ -46,7 +80,7 @@ public:
  * @api ai game
  * @ingroup ScriptList
  */
-class ScriptVehicleList_Depot : public ScriptList {
+class ScriptVehicleList_Depot : public ScriptVehicleList {
 public:
 	/**
 	 * @param tile The tile of the depot to get the list of vehicles from, which have orders to it.
@@ -59,7 +93,7 @@ public:
  * @api ai game
  * @ingroup ScriptList
  */
-class ScriptVehicleList_SharedOrders : public ScriptList {
+class ScriptVehicleList_SharedOrders : public ScriptVehicleList {
 public:
 	/**
 	 * @param vehicle_id The vehicle that the rest shared orders with.
@@ -72,7 +106,7 @@ public:
  * @api ai
  * @ingroup ScriptList
  */
-class ScriptVehicleList_Group : public ScriptList {
+class ScriptVehicleList_Group : public ScriptVehicleList {
 public:
 	/**
 	 * @param group_id The ID of the group the vehicles are in.
@@ -85,7 +119,7 @@ public:
  * @api ai
  * @ingroup ScriptList
  */
-class ScriptVehicleList_DefaultGroup : public ScriptList {
+class ScriptVehicleList_DefaultGroup : public ScriptVehicleList {
 public:
 	/**
 	 * @param vehicle_type The VehicleType to get the list of vehicles for.
@@ -1317,6 +1317,8 @@ public:
 		WID_FRW_ALLOCSIZE                            = ::WID_FRW_ALLOCSIZE,
 		WID_FRW_SEL_MEMORY                           = ::WID_FRW_SEL_MEMORY,
 		WID_FRW_SCROLLBAR                            = ::WID_FRW_SCROLLBAR,
+		WID_FRW_SEL_NEWGRF                           = ::WID_FRW_SEL_NEWGRF,
+		WID_FRW_NEWGRF_COSTS                         = ::WID_FRW_NEWGRF_COSTS,
 	};
 
 	/** Widgets of the #FrametimeGraphWindow class. */
@@ -25,7 +25,11 @@
 
 #include "../company_base.h"
 #include "../company_func.h"
+#include "../command_func.h"
+#include "../network/network.h"
 #include "../fileio_func.h"
+#include <unordered_map>
+#include <vector>
 
 #include "../safeguards.h"
 
@@ -58,7 +62,10 @@ ScriptInstance::ScriptInstance(const char *APIName) :
 	is_save_data_on_stack(false),
 	suspend(0),
 	is_paused(false),
-	callback(nullptr)
+	callback(nullptr),
+	has_died(false),
+	queue_commands(false),
+	has_queued_command(false)
 {
 	this->storage = new ScriptStorage();
 	this->engine  = new Squirrel(APIName);
@@ -165,21 +172,29 @@ void ScriptInstance::Died()
 }
 
 void ScriptInstance::GameLoop()
+{
+	if (!this->StartGameLoop()) return;
+
+	this->ResumeGameLoop(false);
+	this->FinishGameLoop();
+}
+
+bool ScriptInstance::StartGameLoop()
 {
 	ScriptObject::ActiveInstance active(this);
 
-	if (this->IsDead()) return;
+	if (this->IsDead()) return false;
 	if (this->engine->HasScriptCrashed()) {
 		/* The script crashed during saving, kill it here. */
 		this->Died();
-		return;
+		return false;
 	}
-	if (this->is_paused) return;
+	if (this->is_paused) return false;
 	this->controller->ticks++;
 
 	if (this->suspend   < -1) this->suspend++; // Multiplayer suspend, increase up to -1.
-	if (this->suspend   < 0)  return;          // Multiplayer suspend, wait for Continue().
-	if (--this->suspend > 0)  return;          // Singleplayer suspend, decrease to 0.
+	if (this->suspend   < 0)  return false;    // Multiplayer suspend, wait for Continue().
+	if (--this->suspend > 0)  return false;    // Singleplayer suspend, decrease to 0.
 
 	_current_company = ScriptObject::GetCompany();
 
@@ -195,7 +210,7 @@ void ScriptInstance::GameLoop()
 			this->suspend  = e.GetSuspendTime();
 			this->callback = e.GetSuspendCallback();
 
-			return;
+			return false;
 		}
 	}
 
@@ -210,13 +225,13 @@ void ScriptInstance::GameLoop()
 				if (!this->engine->CallMethod(*this->instance, "constructor", MAX_CONSTRUCTOR_OPS) || this->engine->IsSuspended()) {
 					if (this->engine->IsSuspended()) ScriptLog::Error("This script took too long to initialize. Script is not started.");
 					this->Died();
-					return;
+					return false;
 				}
 			}
 			if (!this->CallLoad() || this->engine->IsSuspended()) {
 				if (this->engine->IsSuspended()) ScriptLog::Error("This script took too long in the Load function. Script is not started.");
 				this->Died();
-				return;
+				return false;
 			}
 			ScriptObject::SetAllowDoCommand(true);
 			/* Start the script by calling Start() */
@@ -232,27 +247,76 @@ void ScriptInstance::GameLoop()
 		}
 
 		this->is_started = true;
-		return;
+		return false;
 	}
 	if (this->is_save_data_on_stack) {
 		sq_poptop(this->engine->GetVM());
 		this->is_save_data_on_stack = false;
 	}
 
+	return true;
+}
+
+void ScriptInstance::ResumeGameLoop(bool queue_commands)
+{
+	ScriptObject::ActiveInstance active(this);
+	this->queue_commands = queue_commands;
+
 	/* Continue the VM */
 	try {
-		if (!this->engine->Resume(_settings_game.script.script_max_opcode_till_suspend)) this->Died();
+		if (!this->engine->Resume(_settings_game.script.script_max_opcode_till_suspend)) this->has_died = true;
 	} catch (Script_Suspend &e) {
 		this->suspend  = e.GetSuspendTime();
 		this->callback = e.GetSuspendCallback();
 	} catch (Script_FatalError &e) {
+		ScriptNativeScope native_scope;
 		this->is_dead = true;
 		this->engine->ThrowError(e.GetErrorMessage());
 		this->engine->ResumeError();
+		this->has_died = true;
+	}
+
+	this->queue_commands = false;
+}
+
+void ScriptInstance::SetThreadedRandomSeed(uint32 seed)
+{
+	ScriptObject::ActiveInstance active(this);
+	ScriptObject::GetThreadedRandom().SetSeed(seed);
+}
+
+void ScriptInstance::FinishGameLoop()
+{
+	ScriptObject::ActiveInstance active(this);
+
+	if (this->has_died) {
+		this->has_died = false;
 		this->Died();
+		return;
+	}
+
+	if (this->has_queued_command) {
+		this->has_queued_command = false;
+
+		CommandCallback *callback = this->GetDoCommandCallback();
+		CommandCost res = ::DoCommandPInternal(this->queued_tile, this->queued_p1, this->queued_p2, this->queued_cmd, callback, this->queued_text.c_str(), false, false);
+		/* When networking, the callback is called once the server executed the command. */
+		if (!_networking) callback(res, this->queued_tile, this->queued_p1, this->queued_p2, this->queued_cmd);
 	}
 }
 
+void ScriptInstance::QueueCommand(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd, const char *text)
+{
+	assert(!this->has_queued_command);
+
+	this->has_queued_command = true;
+	this->queued_tile = tile;
+	this->queued_p1 = p1;
+	this->queued_p2 = p2;
+	this->queued_cmd = cmd;
+	this->queued_text = text != nullptr ? text : "";
+}
+
 void ScriptInstance::CollectGarbage() const
 {
 	if (this->is_started && !this->IsDead()) this->engine->CollectGarbage();
@@ -308,22 +372,38 @@ void *ScriptInstance::GetLogPointer()
 /*
  * All data is stored in the following format:
  * First 1 byte indicating if there is a data blob at all.
- * 1 byte indicating the type of data.
- * The data itself, this differs per type:
+ * Then the length of the data blob as uint32, followed by the data blob itself.
+ * Numbers in the data blob are stored as variable length integers, in groups
+ * of 7 bits with the least significant group first, and the most significant
+ * bit of each byte set when another group follows. Signed numbers are zigzag
+ * encoded, so small negative numbers stay small too.
+ * The data blob is 1 byte indicating the type of data, then the data itself,
+ * this differs per type:
+ *  - integer: the integer (signed number).
+ *  - string:  the length of the string (number), then the characters of the
+ *             string without terminating '\0'.
+ *  - string reference: the index of a string earlier in the data (number);
+ *             every string is only stored once, later occurrences refer to it.
+ *  - array:   the number of data-elements (number), then all data-elements of
+ *             the array are saved recursive in this format.
+ *  - table:   the number of key/value pairs (number), then all key/value pairs
+ *             are saved in this format (first key 1, then value 1, then key 2,
+ *             etc.). All keys and values can have an arbitrary type (as long as
+ *             it is supported by the save function of course).
+ *  - bool:    A single byte with value 1 representing true and 0 false.
+ *  - null:    No data.
+ *
+ * Before #SLV_SCRIPT_BINARY_DATA there was no length nor data blob, but the
+ * data followed directly, with each value written separately:
  *  - integer: a binary representation of the integer (int32).
  *  - string:  First one byte with the string length, then a 0-terminated char
  *             array. The string can't be longer than 255 bytes (including
  *             terminating '\0').
- *  - array:   All data-elements of the array are saved recursive in this
- *             format, and ended with an element of the type
- *             SQSL_ARRAY_TABLE_END.
- *  - table:   All key/value pairs are saved in this format (first key 1, then
- *             value 1, then key 2, etc.). All keys and values can have an
- *             arbitrary type (as long as it is supported by the save function
- *             of course). The table is ended with an element of the type
+ *  - array:   All data-elements of the array, ended with an element of the
+ *             type SQSL_ARRAY_TABLE_END.
+ *  - table:   All key/value pairs, ended with an element of the type
  *             SQSL_ARRAY_TABLE_END.
- *  - bool:    A single byte with value 1 representing true and 0 false.
- *  - null:    No data.
+ *  - bool and null like above.
  */
 
 /** The type of the data that follows in the savegame. */
@@ -334,6 +414,7 @@ enum SQSaveLoadType {
 	SQSL_TABLE           = 0x03, ///< The following data is an table.
 	SQSL_BOOL            = 0x04, ///< The following data is a boolean.
 	SQSL_NULL            = 0x05, ///< A null variable.
+	SQSL_STRING_REF      = 0x06, ///< The following data refers to an earlier string.
 	SQSL_ARRAY_TABLE_END = 0xFF, ///< Marks the end of an array or table, no data follows.
 };
 
@@ -345,7 +426,132 @@ static const SaveLoad _script_byte[] = {
 	SLE_END()
 };
 
-/* static */ bool ScriptInstance::SaveObject(HSQUIRRELVM vm, SQInteger index, int max_depth, bool test)
+/** Serialises the save data of a script into a data blob. */
+class ScriptDataWriter {
+	std::vector<byte> data;                          ///< The data blob.
+	std::unordered_map<std::string, uint32> strings; ///< Index of every string written so far.
+
+public:
+	/** Write a single byte. */
+	void WriteByte(byte value)
+	{
+		this->data.push_back(value);
+	}
+
+	/** Write an unsigned number as variable length integer. */
+	void WriteNumber(uint64 value)
+	{
+		while (value >= 0x80) {
+			this->data.push_back((byte)(value | 0x80));
+			value >>= 7;
+		}
+		this->data.push_back((byte)value);
+	}
+
+	/** Write a signed number as zigzag encoded variable length integer. */
+	void WriteSignedNumber(int64 value)
+	{
+		this->WriteNumber(((uint64)value << 1) ^ (uint64)(value >> 63));
+	}
+
+	/** Write a string, or a reference to it when it was written before. */
+	void WriteString(const char *str, size_t length)
+	{
+		auto it = this->strings.emplace(std::string(str, length), (uint32)this->strings.size());
+		if (!it.second) {
+			this->WriteByte(SQSL_STRING_REF);
+			this->WriteNumber(it.first->second);
+			return;
+		}
+
+		this->WriteByte(SQSL_STRING);
+		this->WriteNumber(length);
+		this->data.insert(this->data.end(), str, str + length);
+	}
+
+	/** Write the data blob to the savegame. */
+	void Save()
+	{
+		uint32 length = (uint32)this->data.size();
+		SlArray(&length, 1, SLE_UINT32);
+		SlArray(this->data.data(), length, SLE_UINT8);
+	}
+};
+
+/** Deserialises the save data of a script from a data blob. */
+class ScriptDataReader {
+	std::vector<byte> data;                          ///< The data blob.
+	size_t pos;                                      ///< Position of the next byte to read.
+	std::vector<std::pair<size_t, size_t>> strings;  ///< Position and length of every string read so far.
+
+public:
+	/** Read the data blob from the savegame. */
+	ScriptDataReader() : pos(0)
+	{
+		uint32 length;
+		SlArray(&length, 1, SLE_UINT32);
+		this->data.resize(length);
+		SlArray(this->data.data(), length, SLE_UINT8);
+	}
+
+	/** Read a single byte. */
+	byte ReadByte()
+	{
+		if (this->pos >= this->data.size()) SlErrorCorrupt("Script data is truncated");
+		return this->data[this->pos++];
+	}
+
+	/** Read an unsigned number stored as variable length integer. */
+	uint64 ReadNumber()
+	{
+		uint64 value = 0;
+		for (uint shift = 0; shift < 64; shift += 7) {
+			byte b = this->ReadByte();
+			value |= (uint64)(b & 0x7F) << shift;
+			if ((b & 0x80) == 0) return value;
+		}
+		SlErrorCorrupt("Invalid number in script data");
+	}
+
+	/** Read a signed number stored as zigzag encoded variable length integer. */
+	int64 ReadSignedNumber()
+	{
+		uint64 value = this->ReadNumber();
+		return (int64)(value >> 1) ^ -(int64)(value & 1);
+	}
+
+	/**
+	 * Read a string, or a reference to an earlier one.
+	 * @param type The type of the data, #SQSL_STRING or #SQSL_STRING_REF.
+	 * @param[out] length The length of the string.
+	 * @return The string; not '\0' terminated.
+	 */
+	const char *ReadString(byte type, size_t *length)
+	{
+		size_t start;
+		if (type == SQSL_STRING_REF) {
+			uint64 index = this->ReadNumber();
+			if (index >= this->strings.size()) SlErrorCorrupt("Invalid string reference in script data");
+			start = this->strings[index].first;
+			*length = this->strings[index].second;
+		} else {
+			*length = this->ReadNumber();
+			start = this->pos;
+			if (*length > this->data.size() - start) SlErrorCorrupt("Script data is truncated");
+			this->pos += *length;
+			this->strings.emplace_back(start, *length);
+		}
+		return reinterpret_cast<const char *>(this->data.data() + start);
+	}
+
+	/** Check whether all data has been read. */
+	bool IsDone() const
+	{
+		return this->pos == this->data.size();
+	}
+};
+
+/* static */ bool ScriptInstance::SaveObject(HSQUIRRELVM vm, SQInteger index, int max_depth, ScriptDataWriter &writer)
 {
 	if (max_depth == 0) {
 		ScriptLog::Error("Savedata can only be nested to 25 deep. No data saved."); // SQUIRREL_MAX_DEPTH = 25
@@ -354,71 +560,29 @@ static const SaveLoad _script_byte[] = {
 
 	switch (sq_gettype(vm, index)) {
 		case OT_INTEGER: {
-			if (!test) {
-				_script_sl_byte = SQSL_INT;
-				SlObject(nullptr, _script_byte);
-			}
 			SQInteger res;
 			sq_getinteger(vm, index, &res);
-			if (!test) {
-				int value = (int)res;
-				SlArray(&value, 1, SLE_INT32);
-			}
+			writer.WriteByte(SQSL_INT);
+			writer.WriteSignedNumber(res);
 			return true;
 		}
 
 		case OT_STRING: {
-			if (!test) {
-				_script_sl_byte = SQSL_STRING;
-				SlObject(nullptr, _script_byte);
-			}
 			const SQChar *buf;
 			sq_getstring(vm, index, &buf);
-			size_t len = strlen(buf) + 1;
-			if (len >= 255) {
-				ScriptLog::Error("Maximum string length is 254 chars. No data saved.");
-				return false;
-			}
-			if (!test) {
-				_script_sl_byte = (byte)len;
-				SlObject(nullptr, _script_byte);
-				SlArray(const_cast<char *>(buf), len, SLE_CHAR);
-			}
-			return true;
-		}
-
-		case OT_ARRAY: {
-			if (!test) {
-				_script_sl_byte = SQSL_ARRAY;
-				SlObject(nullptr, _script_byte);
-			}
-			sq_pushnull(vm);
-			while (SQ_SUCCEEDED(sq_next(vm, index - 1))) {
-				/* Store the value */
-				bool res = SaveObject(vm, -1, max_depth - 1, test);
-				sq_pop(vm, 2);
-				if (!res) {
-					sq_pop(vm, 1);
-					return false;
-				}
-			}
-			sq_pop(vm, 1);
-			if (!test) {
-				_script_sl_byte = SQSL_ARRAY_TABLE_END;
-				SlObject(nullptr, _script_byte);
-			}
+			writer.WriteString(buf, sq_getsize(vm, index));
 			return true;
 		}
 
+		case OT_ARRAY:
 		case OT_TABLE: {
-			if (!test) {
-				_script_sl_byte = SQSL_TABLE;
-				SlObject(nullptr, _script_byte);
-			}
+			bool is_table = sq_gettype(vm, index) == OT_TABLE;
+			writer.WriteByte(is_table ? SQSL_TABLE : SQSL_ARRAY);
+			writer.WriteNumber(sq_getsize(vm, index));
 			sq_pushnull(vm);
 			while (SQ_SUCCEEDED(sq_next(vm, index - 1))) {
-				/* Store the key + value */
-				bool res = SaveObject(vm, -2, max_depth - 1, test) && SaveObject(vm, -1, max_depth - 1, test);
+				/* Store the key (only for tables) + value */
+				bool res = (!is_table || SaveObject(vm, -2, max_depth - 1, writer)) && SaveObject(vm, -1, max_depth - 1, writer);
 				sq_pop(vm, 2);
 				if (!res) {
 					sq_pop(vm, 1);
@@ -426,32 +590,19 @@ static const SaveLoad _script_byte[] = {
 				}
 			}
 			sq_pop(vm, 1);
-			if (!test) {
-				_script_sl_byte = SQSL_ARRAY_TABLE_END;
-				SlObject(nullptr, _script_byte);
-			}
 			return true;
 		}
 
 		case OT_BOOL: {
-			if (!test) {
-				_script_sl_byte = SQSL_BOOL;
-				SlObject(nullptr, _script_byte);
-			}
 			SQBool res;
 			sq_getbool(vm, index, &res);
-			if (!test) {
-				_script_sl_byte = res ? 1 : 0;
-				SlObject(nullptr, _script_byte);
-			}
+			writer.WriteByte(SQSL_BOOL);
+			writer.WriteByte(res ? 1 : 0);
 			return true;
 		}
 
 		case OT_NULL: {
-			if (!test) {
-				_script_sl_byte = SQSL_NULL;
-				SlObject(nullptr, _script_byte);
-			}
+			writer.WriteByte(SQSL_NULL);
 			return true;
 		}
 
@@ -478,11 +629,13 @@ void ScriptInstance::Save()
 	}
 
 	HSQUIRRELVM vm = this->engine->GetVM();
+	ScriptDataWriter writer;
 	if (this->is_save_data_on_stack) {
+		/* Save the data that was just loaded. */
+		SaveObject(vm, -1, SQUIRREL_MAX_DEPTH, writer);
 		_script_sl_byte = 1;
 		SlObject(nullptr, _script_byte);
-		/* Save the data that was just loaded. */
-		SaveObject(vm, -1, SQUIRREL_MAX_DEPTH, false);
+		writer.Save();
 	} else if (!this->is_started) {
 		SaveEmpty();
 		return;
@@ -521,10 +674,10 @@ void ScriptInstance::Save()
 			return;
 		}
 		sq_pushobject(vm, savedata);
-		if (SaveObject(vm, -1, SQUIRREL_MAX_DEPTH, true)) {
+		if (SaveObject(vm, -1, SQUIRREL_MAX_DEPTH, writer)) {
 			_script_sl_byte = 1;
 			SlObject(nullptr, _script_byte);
-			SaveObject(vm, -1, SQUIRREL_MAX_DEPTH, false);
+			writer.Save();
 			this->is_save_data_on_stack = true;
 		} else {
 			SaveEmpty();
@@ -613,13 +766,83 @@ bool ScriptInstance::IsPaused()
 	}
 }
 
+/* static */ void ScriptInstance::LoadObject(HSQUIRRELVM vm, int max_depth, ScriptDataReader &reader)
+{
+	if (max_depth == 0) SlErrorCorrupt("Script data is nested too deep");
+
+	byte type = reader.ReadByte();
+	switch (type) {
+		case SQSL_INT: {
+			SQInteger value = reader.ReadSignedNumber();
+			if (vm != nullptr) sq_pushinteger(vm, value);
+			break;
+		}
+
+		case SQSL_STRING:
+		case SQSL_STRING_REF: {
+			size_t length;
+			const char *buf = reader.ReadString(type, &length);
+			if (vm != nullptr) sq_pushstring(vm, buf, length);
+			break;
+		}
+
+		case SQSL_ARRAY: {
+			uint64 count = reader.ReadNumber();
+			if (vm != nullptr) sq_newarray(vm, 0);
+			for (; count != 0; count--) {
+				LoadObject(vm, max_depth - 1, reader);
+				if (vm != nullptr) sq_arrayappend(vm, -2);
+				/* The value is popped from the stack by squirrel. */
+			}
+			break;
+		}
+
+		case SQSL_TABLE: {
+			uint64 count = reader.ReadNumber();
+			if (vm != nullptr) sq_newtable(vm);
+			for (; count != 0; count--) {
+				LoadObject(vm, max_depth - 1, reader);
+				LoadObject(vm, max_depth - 1, reader);
+				if (vm != nullptr) sq_rawset(vm, -3);
+				/* The key (-2) and value (-1) are popped from the stack by squirrel. */
+			}
+			break;
+		}
+
+		case SQSL_BOOL: {
+			byte value = reader.ReadByte();
+			if (vm != nullptr) sq_pushbool(vm, (SQBool)(value != 0));
+			break;
+		}
+
+		case SQSL_NULL: {
+			if (vm != nullptr) sq_pushnull(vm);
+			break;
+		}
+
+		default: SlErrorCorrupt("Invalid script data");
+	}
+}
+
+/* static */ void ScriptInstance::LoadData(HSQUIRRELVM vm)
+{
+	if (IsSavegameVersionBefore(SLV_SCRIPT_BINARY_DATA)) {
+		LoadObjects(vm);
+		return;
+	}
+
+	ScriptDataReader reader;
+	LoadObject(vm, SQUIRREL_MAX_DEPTH, reader);
+	if (!reader.IsDone()) SlErrorCorrupt("Script data has trailing bytes");
+}
+
 /* static */ void ScriptInstance::LoadEmpty()
 {
 	SlObject(nullptr, _script_byte);
 	/* Check if there was anything saved at all. */
 	if (_script_sl_byte == 0) return;
 
-	LoadObjects(nullptr);
+	LoadData(nullptr);
 }
 
 void ScriptInstance::Load(int version)
@@ -637,7 +860,7 @@ void ScriptInstance::Load(int version)
 	if (_script_sl_byte == 0) return;
 
 	sq_pushinteger(vm, version);
-	LoadObjects(vm);
+	LoadData(vm);
 	this->is_save_data_on_stack = true;
 }
 
@@ -683,6 +906,11 @@ SQInteger ScriptInstance::GetOpsTillSuspend()
 	return this->engine->GetOpsTillSuspend();
 }
 
+void ScriptInstance::DecreaseOps(int ops)
+{
+	Squirrel::DecreaseOps(this->engine->GetVM(), ops);
+}
+
 bool ScriptInstance::DoCommandCallback(const CommandCost &result, TileIndex tile, uint32 p1, uint32 p2, uint32 cmd)
 {
 	ScriptObject::ActiveInstance active(this);
@@ -11,6 +11,7 @@
 #define SCRIPT_INSTANCE_HPP
 
 #include <squirrel.h>
+#include <string>
 #include "script_suspend.hpp"
 
 #include "../command_type.h"
@@ -19,6 +20,9 @@
 
 static const uint SQUIRREL_MAX_DEPTH = 25; ///< The maximum recursive depth for items stored in the savegame.
 
+class ScriptDataWriter;
+class ScriptDataReader;
+
 /** Runtime information about a script like a pointer to the squirrel vm and the current state. */
 class ScriptInstance {
 public:
@@ -65,6 +69,33 @@ public:
 	 */
 	void GameLoop();
 
+	/**
+	 * Run the part of the GameLoop before the VM of the script is resumed.
+	 * @return True if the VM has to be resumed by ResumeGameLoop().
+	 */
+	bool StartGameLoop();
+
+	/**
+	 * Resume the VM of the script. This may be called from a worker thread,
+	 *  but then ScriptNativeScope has to be set up for threading.
+	 * @param queue_commands Whether to queue DoCommands for FinishGameLoop(),
+	 *  instead of executing them directly.
+	 */
+	void ResumeGameLoop(bool queue_commands);
+
+	/**
+	 * Run the part of the GameLoop after the VM of the script was resumed.
+	 */
+	void FinishGameLoop();
+
+	/**
+	 * Seed the random the script draws from while it runs on a worker thread.
+	 * To keep games reproducible, call this from the main thread for the
+	 *  scripts in a fixed order.
+	 * @param seed The seed.
+	 */
+	void SetThreadedRandomSeed(uint32 seed);
+
 	/**
 	 * Let the VM collect any garbage.
 	 */
@@ -174,6 +205,13 @@ public:
 	 */
 	SQInteger GetOpsTillSuspend();
 
+	/**
+	 * Charge the script for operations that were done natively on its behalf.
+	 * This function is safe to call from within a function called by the script.
+	 * @param ops The number of operations to charge.
+	 */
+	void DecreaseOps(int ops);
+
 	/**
 	 * DoCommand callback function for all commands executed by scripts.
 	 * @param result The result of the command.
@@ -244,6 +282,25 @@ private:
 	bool is_paused;                       ///< Is the script paused? (a paused script will not be executed until unpaused)
 	Script_SuspendCallbackProc *callback; ///< Callback that should be called in the next tick the script runs.
 	size_t last_allocated_memory;         ///< Last known allocated memory value (for display for crashed scripts)
+	bool has_died;                        ///< Did the script die while its VM was resumed? Then FinishGameLoop() has to call Died().
+
+	bool queue_commands;                  ///< Should DoCommands be queued, instead of being executed directly?
+	bool has_queued_command;              ///< Is there a DoCommand waiting to be executed by FinishGameLoop()?
+	TileIndex queued_tile;                ///< Tile of the queued DoCommand.
+	uint32 queued_p1;                     ///< p1 of the queued DoCommand.
+	uint32 queued_p2;                     ///< p2 of the queued DoCommand.
+	uint32 queued_cmd;                    ///< The queued DoCommand.
+	std::string queued_text;              ///< Text of the queued DoCommand.
+
+	/**
+	 * Queue a DoCommand, to be executed by FinishGameLoop().
+	 * @param tile The tile to execute the command on.
+	 * @param p1 p1 of the command.
+	 * @param p2 p2 of the command.
+	 * @param cmd The command to execute.
+	 * @param text Text of the command, may be \c nullptr.
+	 */
+	void QueueCommand(TileIndex tile, uint32 p1, uint32 p2, uint32 cmd, const char *text);
 
 	/**
 	 * Call the script Load function if it exists and data was loaded
@@ -252,22 +309,35 @@ private:
 	bool CallLoad();
 
 	/**
-	 * Save one object (int / string / array / table) to the savegame.
+	 * Save one object (int / string / array / table) to the savegame data.
 	 * @param vm The virtual machine to get all the data from.
 	 * @param index The index on the squirrel stack of the element to save.
 	 * @param max_depth The maximum depth recursive arrays / tables will be stored
 	 *   with before an error is returned.
-	 * @param test If true, don't really store the data but only check if it is
-	 *   valid.
+	 * @param writer The writer to serialise the object with.
 	 * @return True if the saving was successful.
 	 */
-	static bool SaveObject(HSQUIRRELVM vm, SQInteger index, int max_depth, bool test);
+	static bool SaveObject(HSQUIRRELVM vm, SQInteger index, int max_depth, ScriptDataWriter &writer);
 
 	/**
-	 * Load all objects from a savegame.
+	 * Load one object from the savegame data.
+	 * @param vm The virtual machine to push the object to, or \c nullptr to only skip it.
+	 * @param max_depth The maximum depth recursive arrays / tables can have.
+	 * @param reader The reader to deserialise the object with.
+	 */
+	static void LoadObject(HSQUIRRELVM vm, int max_depth, ScriptDataReader &reader);
+
+	/**
+	 * Load all objects from a savegame from before #SLV_SCRIPT_BINARY_DATA.
 	 * @return True if the loading was successful.
 	 */
 	static bool LoadObjects(HSQUIRRELVM vm);
+
+	/**
+	 * Load the data blob of a script from the savegame.
+	 * @param vm The virtual machine to push the data to, or \c nullptr to discard it.
+	 */
+	static void LoadData(HSQUIRRELVM vm);
 };
 
 #endif /* SCRIPT_INSTANCE_HPP */
@@ -16,6 +16,7 @@
 #include "../group.h"
 #include "../goal_type.h"
 #include "../story_type.h"
+#include "../core/random_func.hpp"
 
 #include "table/strings.h"
 #include <vector>
@@ -64,6 +65,8 @@ private:
 	void *event_data;                ///< Pointer to the event data storage.
 	void *log_data;                  ///< Pointer to the log data storage.
 
+	Randomizer threaded_random;      ///< The random the script draws from while it runs on a worker thread.
+
 public:
 	ScriptStorage() :
 		mode              (nullptr),
@@ -91,6 +94,7 @@ public:
 		rail_type         (INVALID_RAILTYPE),
 		event_data        (nullptr),
 		log_data          (nullptr)
+		/* threaded_random is seeded before it is used */
 	{ }
 
 	~ScriptStorage();
@@ -9,6 +9,8 @@
 
 #include <stdarg.h>
 #include <map>
+#include <mutex>
+#include <vector>
 #include "../stdafx.h"
 #include "../debug.h"
 #include "squirrel_std.hpp"
@@ -16,6 +18,7 @@
 #include "../string_func.h"
 #include "script_fatalerror.hpp"
 #include "../settings_type.h"
+#include "../company_func.h"
 #include <sqstdaux.h>
 #include <../squirrel/sqpcheader.h>
 #include <../squirrel/sqvm.h>
@@ -29,12 +32,35 @@
 #define SCRIPT_DEBUG_ALLOCATIONS
 */
 
+/**
+ * Allocator for the memory of a single script.
+ * Small allocations, which are the bulk of what Squirrel allocates for its tables,
+ * arrays, strings and closures, are served from pools of fixed size blocks carved
+ * out of big chunks owned by the allocator. That keeps the churn of the script off
+ * the global heap, and releases all the memory of the pools at once when the script
+ * is destroyed. Only bigger allocations are passed on to the heap.
+ */
 struct ScriptAllocator {
 	size_t allocated_size;   ///< Sum of allocated data size
 	size_t allocation_limit; ///< Maximum this allocator may use before allocations fail
 
 	static const size_t SAFE_LIMIT = 0x8000000; ///< 128 MiB, a safe choice for almost any situation
 
+	static const size_t POOL_GRANULARITY = 8;        ///< The block sizes of the pools are a multiple of this.
+	static const size_t POOL_MAX_SIZE = 256;         ///< Largest allocation served from the pools.
+	static const size_t POOL_COUNT = POOL_MAX_SIZE / POOL_GRANULARITY; ///< Number of pools, one for every block size.
+	static const size_t POOL_CHUNK_SIZE = 64 * 1024; ///< Size of the chunks the blocks are carved from.
+
+	/** A freed block of a pool. */
+	struct FreeBlock {
+		FreeBlock *next; ///< Next freed block of the same pool.
+	};
+
+	std::vector<char *> chunks;         ///< The chunks the blocks of the pools are carved from.
+	char *chunk_pos;                    ///< Start of the part of the last chunk that is not carved into blocks yet.
+	char *chunk_end;                    ///< End of the last chunk.
+	FreeBlock *free_blocks[POOL_COUNT]; ///< Freed blocks of each pool, ready for reuse.
+
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 	std::map<void *, size_t> allocations;
 #endif
@@ -44,9 +70,61 @@ struct ScriptAllocator {
 		if (this->allocated_size > this->allocation_limit) throw Script_FatalError("Maximum memory allocation exceeded");
 	}
 
+	/**
+	 * Get the pool an allocation is served from.
+	 * @param size The size of the allocation; at most #POOL_MAX_SIZE.
+	 * @return The index of the pool.
+	 */
+	static inline size_t GetPool(size_t size)
+	{
+		return size == 0 ? 0 : (size - 1) / POOL_GRANULARITY;
+	}
+
+	/**
+	 * Get a block from a pool, carving a new one if there are no freed blocks.
+	 * @param pool The index of the pool.
+	 * @return The block.
+	 */
+	void *AllocateBlock(size_t pool)
+	{
+		FreeBlock *block = this->free_blocks[pool];
+		if (block != nullptr) {
+			this->free_blocks[pool] = block->next;
+			return block;
+		}
+
+		size_t block_size = (pool + 1) * POOL_GRANULARITY;
+		if (this->chunk_pos + block_size > this->chunk_end) {
+			/* The rest of the chunk is too small; hand it to the pool of its size instead. */
+			size_t rest = this->chunk_end - this->chunk_pos;
+			if (rest != 0) this->ReleaseBlock(this->chunk_pos, GetPool(rest));
+
+			char *chunk = MallocT<char>(POOL_CHUNK_SIZE);
+			this->chunks.push_back(chunk);
+			this->chunk_pos = chunk;
+			this->chunk_end = chunk + POOL_CHUNK_SIZE;
+		}
+
+		void *p = this->chunk_pos;
+		this->chunk_pos += block_size;
+		return p;
+	}
+
+	/**
+	 * Return a block to its pool.
+	 * @param p The block.
+	 * @param pool The index of the pool.
+	 */
+	void ReleaseBlock(void *p, size_t pool)
+	{
+		FreeBlock *block = static_cast<FreeBlock *>(p);
+		block->next = this->free_blocks[pool];
+		this->free_blocks[pool] = block;
+	}
+
 	void *Malloc(SQUnsignedInteger size)
 	{
-		void *p = MallocT<char>(size);
+		void *p = size <= POOL_MAX_SIZE ? this->AllocateBlock(GetPool(size)) : MallocT<char>(size);
 		this->allocated_size += size;
 
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
@@ -68,6 +146,25 @@ struct ScriptAllocator {
 			return nullptr;
 		}
 
+		if (oldsize <= POOL_MAX_SIZE || size <= POOL_MAX_SIZE) {
+			/* The block of the old size may still be big enough. */
+			if (oldsize <= POOL_MAX_SIZE && size <= POOL_MAX_SIZE && GetPool(oldsize) == GetPool(size)) {
+#ifdef SCRIPT_DEBUG_ALLOCATIONS
+				assert(this->allocations[p] == oldsize);
+				this->allocations[p] = size;
+#endif
+				this->allocated_size -= oldsize;
+				this->allocated_size += size;
+				return p;
+			}
+
+			/* Moving from or to a pool, so it has to be copied over. */
+			void *new_p = this->Malloc(size);
+			memcpy(new_p, p, std::min(oldsize, size));
+			this->Free(p, oldsize);
+			return new_p;
+		}
+
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(this->allocations[p] == oldsize);
 		this->allocations.erase(p);
@@ -90,7 +187,11 @@ struct ScriptAllocator {
 	void Free(void *p, SQUnsignedInteger size)
 	{
 		if (p == nullptr) return;
-		free(p);
+		if (size <= POOL_MAX_SIZE) {
+			this->ReleaseBlock(p, GetPool(size));
+		} else {
+			free(p);
+		}
 		this->allocated_size -= size;
 
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
@@ -99,7 +200,7 @@ struct ScriptAllocator {
 #endif
 	}
 
-	ScriptAllocator()
+	ScriptAllocator() : chunk_pos(nullptr), chunk_end(nullptr), free_blocks()
 	{
 		this->allocated_size = 0;
 		this->allocation_limit = static_cast<size_t>(_settings_game.script.script_max_memory_megabytes) << 20;
@@ -111,10 +212,70 @@ struct ScriptAllocator {
 #ifdef SCRIPT_DEBUG_ALLOCATIONS
 		assert(this->allocations.size() == 0);
 #endif
+		for (char *chunk : this->chunks) free(chunk);
 	}
 };
 
-ScriptAllocator *_squirrel_allocator = nullptr;
+thread_local ScriptAllocator *_squirrel_allocator = nullptr;
+
+static std::recursive_mutex _script_native_mutex; ///< Lock for scripts running native code on worker threads.
+static bool _script_native_threaded = false;      ///< Whether scripts are running on worker threads.
+static thread_local CompanyID _script_native_company = INVALID_COMPANY; ///< The company a thread runs scripts for.
+
+ScriptNativeScope::ScriptNativeScope() : locked(_script_native_threaded)
+{
+	if (!this->locked) return;
+
+	_script_native_mutex.lock();
+	_current_company = _script_native_company;
+}
+
+ScriptNativeScope::~ScriptNativeScope()
+{
+	if (this->locked) _script_native_mutex.unlock();
+}
+
+ScriptNativeCallbackScope::ScriptNativeCallbackScope() : unlocked(_script_native_threaded)
+{
+	if (this->unlocked) _script_native_mutex.unlock();
+}
+
+ScriptNativeCallbackScope::~ScriptNativeCallbackScope()
+{
+	if (!this->unlocked) return;
+
+	/* Other scripts may have changed the current company meanwhile. */
+	_script_native_mutex.lock();
+	_current_company = _script_native_company;
+}
+
+/**
+ * Set whether scripts are running on worker threads. This may only be
+ * changed from the main thread while no script is running.
+ * @param threaded Whether scripts will run on worker threads.
+ */
+/* static */ void ScriptNativeScope::SetThreaded(bool threaded)
+{
+	_script_native_threaded = threaded;
+}
+
+/**
+ * Check whether scripts are running on worker threads.
+ * @return True iff scripts are running on worker threads.
+ */
+/* static */ bool ScriptNativeScope::IsThreaded()
+{
+	return _script_native_threaded;
+}
+
+/**
+ * Set the company the current thread will run a script for.
+ * @param company The company.
+ */
+/* static */ void ScriptNativeScope::SetThreadCompany(CompanyID company)
+{
+	_script_native_company = company;
+}
 
 /* See 3rdparty/squirrel/squirrel/sqmem.cpp for the default allocator implementation, which this overrides */
 #ifndef SQUIRREL_DEFAULT_ALLOCATOR
@@ -132,6 +293,8 @@ size_t Squirrel::GetAllocatedMemory() const noexcept
 
 void Squirrel::CompileError(HSQUIRRELVM vm, const SQChar *desc, const SQChar *source, SQInteger line, SQInteger column)
 {
+	ScriptNativeScope native_scope;
+
 	SQChar buf[1024];
 
 	seprintf(buf, lastof(buf), "Error %s:" OTTD_PRINTF64 "/" OTTD_PRINTF64 ": %s", source, line, column, desc);
@@ -149,6 +312,8 @@ void Squirrel::CompileError(HSQUIRRELVM vm, const SQChar *desc, const SQChar *so
 
 void Squirrel::ErrorPrintFunc(HSQUIRRELVM vm, const SQChar *s, ...)
 {
+	ScriptNativeScope native_scope;
+
 	va_list arglist;
 	SQChar buf[1024];
 
@@ -167,6 +332,8 @@ void Squirrel::ErrorPrintFunc(HSQUIRRELVM vm, const SQChar *s, ...)
 
 void Squirrel::RunError(HSQUIRRELVM vm, const SQChar *error)
 {
+	ScriptNativeScope native_scope;
+
 	/* Set the print function to something that prints to stderr */
 	SQPRINTFUNCTION pf = sq_getprintfunc(vm);
 	sq_setprintfunc(vm, &Squirrel::ErrorPrintFunc);
@@ -205,6 +372,8 @@ SQInteger Squirrel::_RunError(HSQUIRRELVM vm)
 
 void Squirrel::PrintFunc(HSQUIRRELVM vm, const SQChar *s, ...)
 {
+	ScriptNativeScope native_scope;
+
 	va_list arglist;
 	SQChar buf[1024];
 
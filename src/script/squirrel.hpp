@@ -11,6 +11,7 @@
 #define SQUIRREL_HPP
 
 #include <squirrel.h>
+#include "../company_type.h"
 
 /** The type of script we're working with, i.e. for who is it? */
 enum ScriptType {
@@ -283,7 +284,7 @@ public:
 };
 
 
-extern ScriptAllocator *_squirrel_allocator;
+extern thread_local ScriptAllocator *_squirrel_allocator;
 
 class ScriptAllocatorScope {
 	ScriptAllocator *old_allocator;
@@ -302,4 +303,36 @@ public:
 	}
 };
 
+/**
+ * Scope in which a script runs native code, which may access the game state.
+ * While scripts run on worker threads only one of them can be in such a scope
+ * at a time, and for that time #_current_company is the company the thread
+ * runs a script for. Otherwise the scope does nothing.
+ */
+class ScriptNativeScope {
+	bool locked; ///< Whether this scope holds the lock.
+
+public:
+	ScriptNativeScope();
+	~ScriptNativeScope();
+
+	static void SetThreaded(bool threaded);
+	static bool IsThreaded();
+	static void SetThreadCompany(CompanyID company);
+};
+
+/**
+ * Scope in which native code calls back into the script, e.g. a valuator.
+ * While scripts run on worker threads the lock of the enclosing
+ * #ScriptNativeScope is released for that time, so other scripts can run
+ * native code meanwhile. Otherwise the scope does nothing.
+ */
+class ScriptNativeCallbackScope {
+	bool unlocked; ///< Whether this scope released the lock.
+
+public:
+	ScriptNativeCallbackScope();
+	~ScriptNativeCallbackScope();
+};
+
 #endif /* SQUIRREL_HPP */
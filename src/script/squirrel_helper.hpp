@@ -735,6 +735,9 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod, ScriptType Ttype>
 	inline SQInteger DefSQNonStaticCallback(HSQUIRRELVM vm)
 	{
+		/* Native code may access the game state, so it has to be run exclusively. */
+		ScriptNativeScope native_scope;
+
 		/* Find the amount of params we got */
 		int nparam = sq_gettop(vm);
 		SQUserPointer ptr = nullptr;
@@ -777,6 +780,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod, ScriptType Ttype>
 	inline SQInteger DefSQAdvancedNonStaticCallback(HSQUIRRELVM vm)
 	{
+		ScriptNativeScope native_scope;
+
 		/* Find the amount of params we got */
 		int nparam = sq_gettop(vm);
 		SQUserPointer ptr = nullptr;
@@ -815,6 +820,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod>
 	inline SQInteger DefSQStaticCallback(HSQUIRRELVM vm)
 	{
+		ScriptNativeScope native_scope;
+
 		/* Find the amount of params we got */
 		int nparam = sq_gettop(vm);
 		SQUserPointer ptr = nullptr;
@@ -839,6 +846,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod>
 	inline SQInteger DefSQAdvancedStaticCallback(HSQUIRRELVM vm)
 	{
+		ScriptNativeScope native_scope;
+
 		/* Find the amount of params we got */
 		int nparam = sq_gettop(vm);
 		SQUserPointer ptr = nullptr;
@@ -859,6 +868,8 @@ namespace SQConvert {
 	template <typename Tcls>
 	static SQInteger DefSQDestructorCallback(SQUserPointer p, SQInteger size)
 	{
+		ScriptNativeScope native_scope;
+
 		/* Remove the real instance too */
 		if (p != nullptr) ((Tcls *)p)->Release();
 		return 0;
@@ -872,6 +883,8 @@ namespace SQConvert {
 	template <typename Tcls, typename Tmethod, int Tnparam>
 	inline SQInteger DefSQConstructorCallback(HSQUIRRELVM vm)
 	{
+		ScriptNativeScope native_scope;
+
 		try {
 			/* Create the real instance */
 			Tcls *instance = HelperT<Tmethod>::SQConstruct((Tcls *)nullptr, (Tmethod)nullptr, vm);
@@ -891,6 +904,8 @@ namespace SQConvert {
 	template <typename Tcls>
 	inline SQInteger DefSQAdvancedConstructorCallback(HSQUIRRELVM vm)
 	{
+		ScriptNativeScope native_scope;
+
 		try {
 			/* Find the amount of params we got */
 			int nparam = sq_gettop(vm);
@@ -41,6 +41,7 @@ SQInteger SquirrelStd::max(HSQUIRRELVM vm)
 
 SQInteger SquirrelStd::require(HSQUIRRELVM vm)
 {
+	ScriptNativeScope native_scope;
 	SQInteger top = sq_gettop(vm);
 	const SQChar *filename;
 
@@ -46,11 +46,15 @@ static const TrackdirBits _enterdir_to_trackdirbits[DIAGDIR_END] = {
 /**
  * Set containing 'items' items of 'tile and Tdir'
  * No tree structure is used because it would cause
- * slowdowns in most usual cases
+ * slowdowns in most usual cases. Instead a small table
+ * counting the items per hash value is kept, so looking
+ * for items that are not in the set does not need a scan.
  */
 template <typename Tdir, uint items>
 struct SmallSet {
 private:
+	static const uint FILTER_BITS = 10; ///< number of bits of the hash of the filter
+
 	uint n;           // actual number of units
 	bool overflowed;  // did we try to overflow the set?
 	const char *name; // name, used for debugging purposes...
@@ -61,15 +65,32 @@ private:
 		Tdir dir;
 	} data[items];
 
+	uint16 filter[1 << FILTER_BITS]; ///< number of items in the set per hash value
+
+	/**
+	 * Get the hash value of an item for the filter.
+	 * @param tile tile
+	 * @param dir dir
+	 * @return the hash value
+	 */
+	static inline uint Hash(TileIndex tile, Tdir dir)
+	{
+		return ((tile * 16 + dir) * 0x9E3779B1U) >> (32 - FILTER_BITS);
+	}
+
 public:
 	/** Constructor - just set default values and 'name' */
-	SmallSet(const char *name) : n(0), overflowed(false), name(name) { }
+	SmallSet(const char *name) : n(0), overflowed(false), name(name)
+	{
+		memset(this->filter, 0, sizeof(this->filter));
+	}
 
 	/** Reset variables to default values */
 	void Reset()
 	{
 		this->n = 0;
 		this->overflowed = false;
+		memset(this->filter, 0, sizeof(this->filter));
 	}
 
 	/**
@@ -117,8 +138,12 @@ public:
 	 */
 	bool Remove(TileIndex tile, Tdir dir)
 	{
+		uint hash = Hash(tile, dir);
+		if (this->filter[hash] == 0) return false;
+
 		for (uint i = 0; i < this->n; i++) {
 			if (this->data[i].tile == tile && this->data[i].dir == dir) {
+				this->filter[hash]--;
 				this->data[i] = this->data[--this->n];
 				return true;
 			}
@@ -135,6 +160,8 @@ public:
 	 */
 	bool IsIn(TileIndex tile, Tdir dir)
 	{
+		if (this->filter[Hash(tile, dir)] == 0) return false;
+
 		for (uint i = 0; i < this->n; i++) {
 			if (this->data[i].tile == tile && this->data[i].dir == dir) return true;
 		}
@@ -160,6 +187,7 @@ public:
 		this->data[this->n].tile = tile;
 		this->data[this->n].dir = dir;
 		this->n++;
+		this->filter[Hash(tile, dir)]++;
 
 		return true;
 	}
@@ -177,6 +205,7 @@ public:
 		this->n--;
 		*tile = this->data[this->n].tile;
 		*dir = this->data[this->n].dir;
+		this->filter[Hash(*tile, *dir)]--;
 
 		return true;
 	}
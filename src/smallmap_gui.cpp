@@ -22,6 +22,7 @@
 #include "window_func.h"
 #include "company_base.h"
 #include "guitimer_func.h"
+#include "thread_pool.h"
 
 #include "smallmap_gui.h"
 
@@ -39,6 +40,12 @@ static int _smallmap_cargo_count;    ///< Number of cargos in the link stats leg
 static uint8 _linkstat_colours_in_legenda[] = {0, 1, 3, 5, 7, 9, 11};
 
 static const int NUM_NO_COMPANY_ENTRIES = 4; ///< Number of entries in the owner legend that are not companies.
+static const uint SMALLMAP_COLUMNS_PER_TASK = 16; ///< Number of columns of pixels whose colours are determined by one task of the thread pool.
+static const uint SMALLMAP_BLOCK_BITS = 4;        ///< Changes of tiles are tracked per square block of tiles that is this many bits wide.
+
+static std::vector<uint32> _smallmap_block_changes; ///< Per block of tiles, the number of the last draw of the smallmap before a tile of the block changed; empty when there is no smallmap.
+static uint _smallmap_blocks_x;                     ///< Number of blocks of tiles in the x direction.
+static uint32 _smallmap_draw_count = 0;             ///< Number of times the smallmap has been drawn.
 
 /** Macro for ordinary entry of LegendAndColour */
 #define MK(a, b) {a, b, INVALID_INDUSTRYTYPE, 0, INVALID_COMPANY, true, false, false}
@@ -579,6 +586,39 @@ static inline uint32 GetSmallMapOwnerPixels(TileIndex tile, TileType t)
 	return MKCOLOUR_XXXX(_legend_land_owners[_company_to_list_pos[o]].colour);
 }
 
+/**
+ * Mark a tile as changed, so the smallmap determines its colours again.
+ * @param tile The changed tile.
+ */
+void MarkSmallMapTileDirty(TileIndex tile)
+{
+	if (_smallmap_block_changes.empty()) return;
+
+	size_t block = (TileY(tile) >> SMALLMAP_BLOCK_BITS) * _smallmap_blocks_x + (TileX(tile) >> SMALLMAP_BLOCK_BITS);
+	if (block < _smallmap_block_changes.size()) _smallmap_block_changes[block] = _smallmap_draw_count;
+}
+
+/**
+ * Get the number of the last draw of the smallmap before any tile of an area changed.
+ * @param ta The area to check.
+ * @return The number of the draw; the colours of the area determined in a later draw are still valid.
+ */
+static uint32 GetSmallMapLastChange(const TileArea &ta)
+{
+	uint x1 = TileX(ta.tile) >> SMALLMAP_BLOCK_BITS;
+	uint y1 = TileY(ta.tile) >> SMALLMAP_BLOCK_BITS;
+	uint x2 = (TileX(ta.tile) + ta.w - 1) >> SMALLMAP_BLOCK_BITS;
+	uint y2 = (TileY(ta.tile) + ta.h - 1) >> SMALLMAP_BLOCK_BITS;
+
+	uint32 last_change = 0;
+	for (uint y = y1; y <= y2; y++) {
+		for (uint x = x1; x <= x2; x++) {
+			last_change = max(last_change, _smallmap_block_changes[y * _smallmap_blocks_x + x]);
+		}
+	}
+	return last_change;
+}
+
 /** Vehicle colours in #SMT_VEHICLES mode. Indexed by #VehicleType. */
 static const byte _vehicle_type_colours[6] = {
 	PC_RED, PC_YELLOW, PC_LIGHT_BLUE, PC_WHITE, PC_BLACK, PC_RED
@@ -815,31 +855,111 @@ inline uint32 SmallMapWindow::GetTileColours(const TileArea &ta) const
 }
 
 /**
- * Draws one column of tiles of the small map in a certain mode onto the screen buffer, skipping the shifted rows in between.
+ * Decide which colours to show to the user for a group of tiles, reusing the
+ * colours of an earlier draw when none of the tiles changed since.
+ * @param ta Tile area to investigate.
+ * @param xc The X coordinate of the first tile of the group of tiles, before limiting it to the map.
+ * @param yc The Y coordinate of the first tile of the group of tiles, before limiting it to the map.
+ * @return Colours to display.
+ * @note Different threads may call this at the same time, as long as they do so for different groups of tiles.
+ */
+inline uint32 SmallMapWindow::GetCachedTileColours(const TileArea &ta, uint xc, uint yc) const
+{
+	int dx = (int)xc - this->cache_tile_x;
+	int dy = (int)yc - this->cache_tile_y;
+	if (dx < 0 || dy < 0 || (uint)dx / this->zoom >= this->cache_width || (uint)dy / this->zoom >= this->cache_height) return this->GetTileColours(ta);
+
+	CachedTileColours &cached = this->colour_cache[dy / this->zoom * this->cache_width + dx / this->zoom];
+	if (cached.draw <= GetSmallMapLastChange(ta)) {
+		cached.colours = this->GetTileColours(ta);
+		cached.draw = _smallmap_draw_count;
+	}
+	return cached.colours;
+}
+
+/**
+ * Make sure #colour_cache covers the groups of tiles around the displayed part
+ * of the map, keeping the colours that are still valid.
+ */
+void SmallMapWindow::UpdateColourCache() const
+{
+	const NWidgetBase *wid = this->GetWidget<NWidgetBase>(WID_SM_MAP);
+	int width = wid->current_x;
+	int height = wid->current_y;
+
+	/* Find the tiles at the corners of the display, with a margin for the columns that stick out. */
+	const Point corners[] = { {-8, -2}, {width + 8, -2}, {-8, height + 2}, {width + 8, height + 2} };
+	int min_x = INT_MAX;
+	int max_x = INT_MIN;
+	int min_y = INT_MAX;
+	int max_y = INT_MIN;
+	for (const Point &corner : corners) {
+		int sub;
+		Point pt = this->PixelToTile(corner.x, corner.y, &sub);
+		min_x = min(min_x, pt.x);
+		max_x = max(max_x, pt.x);
+		min_y = min(min_y, pt.y);
+		max_y = max(max_y, pt.y);
+	}
+
+	int tile_x = this->scroll_x / (int)TILE_SIZE + min_x - 2 * this->zoom;
+	int tile_y = this->scroll_y / (int)TILE_SIZE + min_y - 2 * this->zoom;
+	uint cache_width = (max_x - min_x) / this->zoom + 5;
+	uint cache_height = (max_y - min_y) / this->zoom + 5;
+
+	bool same_look = this->cache_valid && this->cache_zoom == this->zoom && this->cache_map_type == this->map_type &&
+			this->cache_land_colour == _settings_client.gui.smallmap_land_colour && this->cache_show_heightmap == _smallmap_show_heightmap;
+	if (same_look && tile_x == this->cache_tile_x && tile_y == this->cache_tile_y && cache_width == this->cache_width && cache_height == this->cache_height) return;
+
+	std::vector<CachedTileColours> colour_cache(cache_width * cache_height, CachedTileColours{0, 0});
+
+	/* When the map was scrolled, keep the colours of the groups of tiles that are still around. */
+	if (same_look && (tile_x - this->cache_tile_x) % this->zoom == 0 && (tile_y - this->cache_tile_y) % this->zoom == 0) {
+		int offset_x = (tile_x - this->cache_tile_x) / this->zoom;
+		int offset_y = (tile_y - this->cache_tile_y) / this->zoom;
+		for (uint y = 0; y < cache_height; y++) {
+			int old_y = (int)y + offset_y;
+			if (old_y < 0 || old_y >= (int)this->cache_height) continue;
+			for (uint x = 0; x < cache_width; x++) {
+				int old_x = (int)x + offset_x;
+				if (old_x < 0 || old_x >= (int)this->cache_width) continue;
+				colour_cache[y * cache_width + x] = this->colour_cache[old_y * this->cache_width + old_x];
+			}
+		}
+	}
+
+	this->colour_cache.swap(colour_cache);
+	this->cache_tile_x = tile_x;
+	this->cache_tile_y = tile_y;
+	this->cache_width = cache_width;
+	this->cache_height = cache_height;
+	this->cache_zoom = this->zoom;
+	this->cache_map_type = this->map_type;
+	this->cache_land_colour = _settings_client.gui.smallmap_land_colour;
+	this->cache_show_heightmap = _smallmap_show_heightmap;
+	this->cache_valid = true;
+}
+
+/**
+ * Determine the colours of one column of tiles of the small map in a certain mode, skipping the shifted rows in between.
  *
- * @param dst Pointer to a part of the screen buffer to write to.
+ * @param colours Buffer for the colours of the \a reps tiles of the column.
  * @param xc The X coordinate of the first tile in the column.
  * @param yc The Y coordinate of the first tile in the column
- * @param pitch Number of pixels to advance in the screen buffer each time a pixel is written.
  * @param reps Number of lines to draw
- * @param start_pos Position of first pixel to draw.
- * @param end_pos Position of last pixel to draw (exclusive).
- * @param blitter current blitter
- * @note If pixel position is below \c 0, skip drawing.
+ * @note This only reads the map, so different threads may call this at the same time for different columns.
  */
-void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter) const
+void SmallMapWindow::GetSmallMapColumnColours(uint32 *colours, uint xc, uint yc, int reps) const
 {
-	void *dst_ptr_abs_end = blitter->MoveTo(_screen.dst_ptr, 0, _screen.height);
 	uint min_xy = _settings_game.construction.freeform_edges ? 1 : 0;
 
 	do {
+		/* Tiles outside the map range stay black, like the background. */
+		*colours = MKCOLOUR_XXXX(PC_BLACK);
+
 		/* Check if the tile (xc,yc) is within the map range */
 		if (xc >= MapMaxX() || yc >= MapMaxY()) continue;
 
-		/* Check if the dst pointer points to a pixel inside the screen buffer */
-		if (dst < _screen.dst_ptr) continue;
-		if (dst >= dst_ptr_abs_end) continue;
-
 		/* Construct tilearea covered by (xc, yc, xc + this->zoom, yc + this->zoom) such that it is within min_xy limits. */
 		TileArea ta;
 		if (min_xy == 1 && (xc == 0 || yc == 0)) {
@@ -851,15 +971,40 @@ void SmallMapWindow::DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch,
 		}
 		ta.ClampToMap(); // Clamp to map boundaries (may contain MP_VOID tiles!).
 
-		uint32 val = this->GetTileColours(ta);
-		uint8 *val8 = (uint8 *)&val;
+		*colours = this->GetCachedTileColours(ta, xc, yc);
+	/* Switch to next tile in the column */
+	} while (xc += this->zoom, yc += this->zoom, colours++, --reps != 0);
+}
+
+/**
+ * Draws one column of tiles of the small map onto the screen buffer, skipping the shifted rows in between.
+ *
+ * @param dst Pointer to a part of the screen buffer to write to.
+ * @param colours The colours of the tiles of the column, see #GetSmallMapColumnColours.
+ * @param pitch Number of pixels to advance in the screen buffer each time a pixel is written.
+ * @param reps Number of lines to draw
+ * @param start_pos Position of first pixel to draw.
+ * @param end_pos Position of last pixel to draw (exclusive).
+ * @param blitter current blitter
+ * @note If pixel position is below \c 0, skip drawing.
+ */
+void SmallMapWindow::DrawSmallMapColumn(void *dst, const uint32 *colours, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter) const
+{
+	void *dst_ptr_abs_end = blitter->MoveTo(_screen.dst_ptr, 0, _screen.height);
+
+	do {
+		/* Check if the dst pointer points to a pixel inside the screen buffer */
+		if (dst < _screen.dst_ptr) continue;
+		if (dst >= dst_ptr_abs_end) continue;
+
+		const uint8 *val8 = (const uint8 *)colours;
 		int idx = max(0, -start_pos);
 		for (int pos = max(0, start_pos); pos < end_pos; pos++) {
 			blitter->SetPixel(dst, idx, 0, val8[idx]);
 			idx++;
 		}
 	/* Switch to next tile in the column */
-	} while (xc += this->zoom, yc += this->zoom, dst = blitter->MoveTo(dst, pitch, 0), --reps != 0);
+	} while (colours++, dst = blitter->MoveTo(dst, pitch, 0), --reps != 0);
 }
 
 /**
@@ -968,6 +1113,9 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi) const
 	old_dpi = _cur_dpi;
 	_cur_dpi = dpi;
 
+	_smallmap_draw_count++;
+	this->UpdateColourCache();
+
 	/* Clear it */
 	GfxFillRect(dpi->left, dpi->top, dpi->left + dpi->width - 1, dpi->top + dpi->height - 1, PC_BLACK);
 
@@ -981,6 +1129,19 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi) const
 	int x = - dx - 4;
 	int y = 0;
 
+	/* The colours of the columns are determined in parallel; the blitter is only used by the main thread. */
+	struct Column {
+		void *ptr;
+		int tile_x;
+		int tile_y;
+		int reps;
+		int x;
+		int end_pos;
+		size_t colours; ///< Index of the colours of the first tile of the column.
+	};
+	std::vector<Column> columns;
+	size_t num_colours = 0;
+
 	for (;;) {
 		/* Distance from left edge */
 		if (x >= -3) {
@@ -989,7 +1150,8 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi) const
 			int end_pos = min(dpi->width, x + 4);
 			int reps = (dpi->height - y + 1) / 2; // Number of lines.
 			if (reps > 0) {
-				this->DrawSmallMapColumn(ptr, tile_x, tile_y, dpi->pitch * 2, reps, x, end_pos, blitter);
+				columns.push_back({ptr, tile_x, tile_y, reps, x, end_pos, num_colours});
+				num_colours += reps;
 			}
 		}
 
@@ -1006,6 +1168,20 @@ void SmallMapWindow::DrawSmallMap(DrawPixelInfo *dpi) const
 		x += 2;
 	}
 
+	std::vector<uint32> colours(num_colours);
+	static ThreadPool thread_pool("ottd:smallmap");
+	thread_pool.Run(CeilDiv((uint)columns.size(), SMALLMAP_COLUMNS_PER_TASK), [&](uint index) {
+		uint last = min<uint>((uint)columns.size(), (index + 1) * SMALLMAP_COLUMNS_PER_TASK);
+		for (uint i = index * SMALLMAP_COLUMNS_PER_TASK; i < last; i++) {
+			const Column &c = columns[i];
+			this->GetSmallMapColumnColours(&colours[c.colours], c.tile_x, c.tile_y, c.reps);
+		}
+	});
+
+	for (const Column &c : columns) {
+		this->DrawSmallMapColumn(c.ptr, &colours[c.colours], dpi->pitch * 2, c.reps, c.x, c.end_pos, blitter);
+	}
+
 	/* Draw vehicles */
 	if (this->map_type == SMT_CONTOUR || this->map_type == SMT_VEHICLES) this->DrawVehicles(dpi, blitter);
 
@@ -1066,9 +1242,14 @@ void SmallMapWindow::SetupWidgetData()
 	this->GetWidget<NWidgetStacked>(WID_SM_SELECT_BUTTONS)->SetDisplayedPlane(plane);
 }
 
-SmallMapWindow::SmallMapWindow(WindowDesc *desc, int window_number) : Window(desc), refresh(GUITimer(FORCE_REFRESH_PERIOD))
+SmallMapWindow::SmallMapWindow(WindowDesc *desc, int window_number) : Window(desc), refresh(GUITimer(FORCE_REFRESH_PERIOD)), cache_valid(false)
 {
 	_smallmap_industry_highlight = INVALID_INDUSTRYTYPE;
+
+	/* Start tracking the changes of tiles. */
+	_smallmap_blocks_x = MapSizeX() >> SMALLMAP_BLOCK_BITS;
+	_smallmap_block_changes.assign(_smallmap_blocks_x * (MapSizeY() >> SMALLMAP_BLOCK_BITS), 0);
+
 	this->overlay = new LinkGraphOverlay(this, WID_SM_MAP, 0, this->GetOverlayCompanyMask(), 1);
 	this->InitNested(window_number);
 	this->LowerWidget(this->map_type + WID_SM_CONTOUR);
@@ -1090,6 +1271,9 @@ SmallMapWindow::~SmallMapWindow()
 {
 	delete this->overlay;
 	this->BreakIndustryChainLink();
+
+	_smallmap_block_changes.clear();
+	_smallmap_block_changes.shrink_to_fit();
 }
 
 /**
@@ -1403,6 +1587,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 		_smallmap_industry_highlight = new_highlight;
 		this->refresh.SetInterval(_smallmap_industry_highlight != INVALID_INDUSTRYTYPE ? BLINK_PERIOD : FORCE_REFRESH_PERIOD);
 		_smallmap_industry_highlight_state = true;
+		this->InvalidateColourCache();
 		this->SetDirty();
 	}
 }
@@ -1478,6 +1663,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 						this->SelectLegendItem(click_pos, _legend_land_owners, _smallmap_company_count, NUM_NO_COMPANY_ENTRIES);
 					}
 				}
+				this->InvalidateColourCache();
 				this->SetDirty();
 			}
 			break;
@@ -1503,6 +1689,7 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 				tbl->show_on_map = (widget == WID_SM_ENABLE_ALL);
 			}
 			if (this->map_type == SMT_LINKSTATS) this->SetOverlayCargoMask();
+			this->InvalidateColourCache();
 			this->SetDirty();
 			break;
 		}
@@ -1521,12 +1708,15 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
  * - data = 0: Displayed industries at the industry chain window have changed.
  * - data = 1: Companies have changed.
  * - data = 2: Cheat changing the maximum heightlevel has been used, rebuild our heightlevel-to-colour index
+ * - data = 3: The owners of tiles have changed without the tiles being marked dirty.
  * @param gui_scope Whether the call is done from GUI scope. You may not do everything when not in GUI scope. See #InvalidateWindowData() for details.
  */
 /* virtual */ void SmallMapWindow::OnInvalidateData(int data, bool gui_scope)
 {
 	if (!gui_scope) return;
 
+	this->InvalidateColourCache();
+
 	switch (data) {
 		case 1:
 			/* The owner legend has already been rebuilt. */
@@ -1547,6 +1737,10 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 			this->RebuildColourIndexIfNecessary();
 			break;
 
+		case 3:
+			/* Only the cached colours are affected. */
+			break;
+
 		default: NOT_REACHED();
 	}
 	this->SetDirty();
@@ -1587,6 +1781,8 @@ int SmallMapWindow::GetPositionOnLegend(Point pt)
 		}
 	}
 	_smallmap_industry_highlight_state = !_smallmap_industry_highlight_state;
+	/* The highlighted industries blink, everything else only changes with the tiles. */
+	if (_smallmap_industry_highlight != INVALID_INDUSTRYTYPE) this->InvalidateColourCache();
 
 	this->refresh.SetInterval(_smallmap_industry_highlight != INVALID_INDUSTRYTYPE ? BLINK_PERIOD : FORCE_REFRESH_PERIOD);
 	this->SetDirty();
@@ -26,6 +26,7 @@ void BuildIndustriesLegend();
 void ShowSmallMap();
 void BuildLandLegend();
 void BuildOwnerLegend();
+void MarkSmallMapTileDirty(TileIndex tile);
 
 /** Structure for holding relevant data for legends in small map */
 struct LegendAndColour {
@@ -81,6 +82,23 @@ protected:
 	GUITimer refresh; ///< Refresh timer.
 	LinkGraphOverlay *overlay;
 
+	/** Colours of a group of tiles as drawn in the smallmap. */
+	struct CachedTileColours {
+		uint32 colours; ///< Colours of the group of tiles.
+		uint32 draw;    ///< Number of the draw in which the colours were determined, or \c 0 when they are not known.
+	};
+
+	mutable std::vector<CachedTileColours> colour_cache; ///< Colours of the groups of tiles around the displayed part of the map.
+	mutable int cache_tile_x;            ///< X coordinate of the first tile of the first group of tiles in #colour_cache.
+	mutable int cache_tile_y;            ///< Y coordinate of the first tile of the first group of tiles in #colour_cache.
+	mutable uint cache_width;            ///< Number of groups of tiles in the x direction in #colour_cache.
+	mutable uint cache_height;           ///< Number of groups of tiles in the y direction in #colour_cache.
+	mutable int cache_zoom;              ///< Zoom level of #colour_cache.
+	mutable SmallMapType cache_map_type; ///< Map type of #colour_cache.
+	mutable uint8 cache_land_colour;     ///< Land colour scheme of #colour_cache.
+	mutable bool cache_show_heightmap;   ///< Whether #colour_cache shows the heightmap.
+	mutable bool cache_valid;            ///< Whether the contents of #colour_cache can be used.
+
 	static void BreakIndustryChainLink();
 	Point SmallmapRemapCoords(int x, int y) const;
 
@@ -154,7 +172,8 @@ protected:
 	void SetNewScroll(int sx, int sy, int sub);
 
 	void DrawMapIndicators() const;
-	void DrawSmallMapColumn(void *dst, uint xc, uint yc, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter) const;
+	void GetSmallMapColumnColours(uint32 *colours, uint xc, uint yc, int reps) const;
+	void DrawSmallMapColumn(void *dst, const uint32 *colours, int pitch, int reps, int start_pos, int end_pos, Blitter *blitter) const;
 	void DrawVehicles(const DrawPixelInfo *dpi, Blitter *blitter) const;
 	void DrawTowns(const DrawPixelInfo *dpi) const;
 	void DrawSmallMap(DrawPixelInfo *dpi) const;
@@ -166,6 +185,14 @@ protected:
 	void SetOverlayCargoMask();
 	void SetupWidgetData();
 	uint32 GetTileColours(const TileArea &ta) const;
+	uint32 GetCachedTileColours(const TileArea &ta, uint xc, uint yc) const;
+	void UpdateColourCache() const;
+
+	/** Forget all cached colours, for when something else than the tiles changed what the map looks like. */
+	inline void InvalidateColourCache()
+	{
+		this->cache_valid = false;
+	}
 
 	int GetPositionOnLegend(Point pt);
 
@@ -15,6 +15,8 @@
 #include "core/smallvec_type.hpp"
 #include "date_type.h"
 
+#include <unordered_map>
+
 /** Flags of the sort list. */
 enum SortListFlags {
 	VL_NONE       = 0,      ///< no sort
@@ -240,11 +242,40 @@ public:
 		if (this->IsSortable()) MemReverseT(std::vector<T>::data(), std::vector<T>::size());
 	}
 
+	/**
+	 * Sort the items that are out of place into place, by moving each of
+	 * them to the right position among the already sorted items before it.
+	 * This is cheap when only a few items changed place since the last sort.
+	 * When that turns out not to be the case, the sorting is stopped.
+	 *
+	 * @param comp The function to compare two list items
+	 * @return true if the list is sorted, false if sorting was stopped
+	 */
+	template <typename C>
+	bool InsertionSort(C comp)
+	{
+		/* Stop when the items have to be moved much further than a full sort would move them. */
+		size_t budget = std::vector<T>::size() * 16;
+
+		for (auto it = std::vector<T>::begin() + 1; it != std::vector<T>::end(); it++) {
+			if (!comp(*it, *(it - 1))) continue;
+
+			auto pos = std::upper_bound(std::vector<T>::begin(), it, *it, comp);
+			size_t distance = it - pos;
+			if (distance > budget) return false;
+			budget -= distance;
+
+			std::rotate(pos, it, it + 1);
+		}
+		return true;
+	}
+
 	/**
 	 * Sort the list.
 	 *  For the first sorting we use quick sort since it is
-	 *  faster for irregular sorted data. After that we
-	 *  use gsort.
+	 *  faster for irregular sorted data. After that the
+	 *  list is mostly sorted already, so only the items that
+	 *  changed place are moved, unless there are too many.
 	 *
 	 * @param compare The function to compare two list items
 	 * @return true if the list sequence has been altered
@@ -263,15 +294,16 @@ public:
 		if (!this->IsSortable()) return false;
 
 		const bool desc = (this->flags & VL_DESC) != 0;
+		auto comp = [&](const T &a, const T &b) { return desc ? compare(b, a) : compare(a, b); };
 
 		if (this->flags & VL_FIRST_SORT) {
 			CLRBITS(this->flags, VL_FIRST_SORT);
 
-			std::sort(std::vector<T>::begin(), std::vector<T>::end(), [&](const T &a, const T &b) { return desc ? compare(b, a) : compare(a, b); });
+			std::sort(std::vector<T>::begin(), std::vector<T>::end(), comp);
 			return true;
 		}
 
-		std::sort(std::vector<T>::begin(), std::vector<T>::end(), [&](const T &a, const T &b) { return desc ? compare(b, a) : compare(a, b); });
+		if (!this->InsertionSort(comp)) std::sort(std::vector<T>::begin(), std::vector<T>::end(), comp);
 		return true;
 	}
 
@@ -395,6 +427,44 @@ public:
 		CLRBITS(this->flags, VL_REBUILD);
 		SETBITS(this->flags, VL_RESORT | VL_FIRST_SORT);
 	}
+
+	/**
+	 * Notify the sortlist that the rebuild is done, and put the items
+	 * that were in the list before the rebuild back in their previous,
+	 * sorted, order. The new items are put after them. That way only
+	 * the new items have to be moved into place by the resort.
+	 *
+	 * @param previous The items of the list before the rebuild
+	 * @note This forces a resort
+	 * @note The previous items are only compared, so they may refer to things that do not exist anymore
+	 */
+	void RebuildDone(const std::vector<T> &previous)
+	{
+		std::unordered_map<T, size_t> positions;
+		for (size_t i = 0; i < previous.size(); i++) positions[previous[i]] = i;
+
+		std::vector<T> kept(previous.size());
+		std::vector<bool> is_kept(previous.size(), false);
+		std::vector<T> added;
+		for (const T &item : *this) {
+			auto it = positions.find(item);
+			if (it == positions.end() || is_kept[it->second]) {
+				added.push_back(item);
+			} else {
+				kept[it->second] = item;
+				is_kept[it->second] = true;
+			}
+		}
+
+		auto dest = std::vector<T>::begin();
+		for (size_t i = 0; i < kept.size(); i++) {
+			if (is_kept[i]) *dest++ = kept[i];
+		}
+		std::copy(added.begin(), added.end(), dest);
+
+		CLRBITS(this->flags, VL_REBUILD);
+		SETBITS(this->flags, VL_RESORT);
+	}
 };
 
 #endif /* SORTLIST_TYPE_H */
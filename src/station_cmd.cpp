@@ -56,6 +56,7 @@
 #include "linkgraph/refresh.h"
 #include "widgets/station_widget.h"
 #include "tunnelbridge_map.h"
+#include "thread_pool.h"
 
 #include "table/strings.h"
 
@@ -3422,6 +3423,7 @@ static bool StationHandleBigTick(BaseStation *st)
 
 		for (CargoID i = 0; i < NUM_CARGO; i++) {
 			ClrBit(Station::From(st)->goods[i].status, GoodsEntry::GES_ACCEPTED_BIGTICK);
+			Station::From(st)->goods[i].cargo.Compact();
 		}
 	}
 
@@ -3459,9 +3461,41 @@ static void TruncateCargo(const CargoSpec *cs, GoodsEntry *ge, uint amount = UIN
 	}
 }
 
-static void UpdateStationRating(Station *st)
+/** Rating update of one cargo at a station, passed between the phases of UpdateStationRatings(). */
+struct CargoRatingUpdate {
+	CargoID cargo;        ///< The cargo being rated.
+	uint16 callback;      ///< Result of the custom station rating callback, or #CALLBACK_FAILED.
+	uint waiting;         ///< Amount of cargo that may remain waiting.
+	uint waiting_avg;     ///< Average amount of waiting cargo per next hop.
+	bool waiting_changed; ///< Whether cargo has to be removed from the station.
+};
+
+/** Rating update of a station, passed between the phases of UpdateStationRatings(). */
+struct StationRatingUpdate {
+	Station *st;          ///< The station being rated.
+	uint32 seed;          ///< Seed for the random numbers of this station; drawn in station order to stay deterministic.
+	uint first;           ///< Index of the first rated cargo in #_cargo_rating_updates.
+	uint last;            ///< Index after the last rated cargo in #_cargo_rating_updates.
+	bool waiting_changed; ///< Whether the waiting cargo of the station has changed.
+};
+
+static std::vector<StationRatingUpdate> _station_rating_updates; ///< Stations of which the rating is being updated this tick.
+static std::vector<CargoRatingUpdate> _cargo_rating_updates;     ///< Cargoes of which the rating is being updated this tick.
+
+static const uint STATION_RATINGS_PER_TASK = 64; ///< Number of stations rated by a single task of the rating thread pool.
+
+/**
+ * First phase of updating the rating of a station: everything that touches
+ * other stations or NewGRFs, or that needs random numbers from the game.
+ * The actual rating is calculated by ComputeStationRating later on.
+ * @param st The station to rate.
+ */
+static void PrepareStationRating(Station *st)
 {
-	bool waiting_changed = false;
+	StationRatingUpdate update;
+	update.st = st;
+	update.first = (uint)_cargo_rating_updates.size();
+	update.waiting_changed = false;
 
 	byte_inc_sat(&st->time_since_load);
 	byte_inc_sat(&st->time_since_unload);
@@ -3483,26 +3517,13 @@ static void UpdateStationRating(Station *st)
 				ClrBit(ge->status, GoodsEntry::GES_RATING);
 				ge->last_speed = 0;
 				TruncateCargo(cs, ge);
-				waiting_changed = true;
+				update.waiting_changed = true;
 				continue;
 			}
 
-			bool skip = false;
-			int rating = 0;
-			uint waiting = ge->cargo.AvailableCount();
-
-			/* num_dests is at least 1 if there is any cargo as
-			 * INVALID_STATION is also a destination.
-			 */
-			uint num_dests = (uint)ge->cargo.Packets()->MapSize();
-
-			/* Average amount of cargo per next hop, but prefer solitary stations
-			 * with only one or two next hops. They are allowed to have more
-			 * cargo waiting per next hop.
-			 * With manual cargo distribution waiting_avg = waiting / 2 as then
-			 * INVALID_STATION is the only destination.
-			 */
-			uint waiting_avg = waiting / (num_dests + 1);
+			CargoRatingUpdate cargo_update;
+			cargo_update.cargo = cs->Index();
+			cargo_update.callback = CALLBACK_FAILED;
 
 			if (HasBit(cs->callback_mask, CBM_CARGO_STATION_RATING_CALC)) {
 				/* Perform custom station rating. If it succeeds the speed, days in transit and
@@ -3514,99 +3535,163 @@ static void UpdateStationRating(Station *st)
 				uint32 var18 = min(ge->time_since_pickup, 0xFF) | (min(ge->max_waiting_cargo, 0xFFFF) << 8) | (min(last_speed, 0xFF) << 24);
 				/* Convert to the 'old' vehicle types */
 				uint32 var10 = (st->last_vehicle_type == VEH_INVALID) ? 0x0 : (st->last_vehicle_type + 0x10);
-				uint16 callback = GetCargoCallback(CBID_CARGO_STATION_RATING_CALC, var10, var18, cs);
-				if (callback != CALLBACK_FAILED) {
-					skip = true;
-					rating = GB(callback, 0, 14);
-
-					/* Simulate a 15 bit signed value */
-					if (HasBit(callback, 14)) rating -= 0x4000;
-				}
+				cargo_update.callback = GetCargoCallback(CBID_CARGO_STATION_RATING_CALC, var10, var18, cs);
 			}
 
-			if (!skip) {
-				int b = ge->last_speed - 85;
-				if (b >= 0) rating += b >> 2;
-
-				byte waittime = ge->time_since_pickup;
-				if (st->last_vehicle_type == VEH_SHIP) waittime >>= 2;
-				if (waittime <= 21) rating += 25;
-				if (waittime <= 12) rating += 25;
-				if (waittime <= 6) rating += 45;
-				if (waittime <= 3) rating += 35;
-
-				rating -= 90;
-				if (ge->max_waiting_cargo <= 1500) rating += 55;
-				if (ge->max_waiting_cargo <= 1000) rating += 35;
-				if (ge->max_waiting_cargo <= 600) rating += 10;
-				if (ge->max_waiting_cargo <= 300) rating += 20;
-				if (ge->max_waiting_cargo <= 100) rating += 10;
-			}
+			_cargo_rating_updates.push_back(cargo_update);
+		}
+	}
 
-			if (Company::IsValidID(st->owner) && HasBit(st->town->statues, st->owner)) rating += 26;
+	update.last = (uint)_cargo_rating_updates.size();
+	update.seed = update.first != update.last ? Random() : 0;
+	_station_rating_updates.push_back(update);
+}
 
-			byte age = ge->last_age;
-			if (age < 3) rating += 10;
-			if (age < 2) rating += 10;
-			if (age < 1) rating += 13;
+/**
+ * Second phase of updating the rating of a station: calculate the new rating
+ * and the amount of cargo that may remain waiting for each of its cargoes.
+ * This only touches the station itself, so stations can be rated in parallel.
+ * @param update The rating update of the station.
+ */
+static void ComputeStationRating(const StationRatingUpdate &update)
+{
+	const Station *st = update.st;
+	Randomizer random;
+	random.SetSeed(update.seed);
 
-			{
-				int or_ = ge->rating; // old rating
+	for (uint i = update.first; i != update.last; i++) {
+		CargoRatingUpdate &cargo_update = _cargo_rating_updates[i];
+		GoodsEntry *ge = &update.st->goods[cargo_update.cargo];
 
-				/* only modify rating in steps of -2, -1, 0, 1 or 2 */
-				ge->rating = rating = or_ + Clamp(Clamp(rating, 0, 255) - or_, -2, 2);
+		bool skip = false;
+		int rating = 0;
+		uint waiting = ge->cargo.AvailableCount();
 
-				/* if rating is <= 64 and more than 100 items waiting on average per destination,
-				 * remove some random amount of goods from the station */
-				if (rating <= 64 && waiting_avg >= 100) {
-					int dec = Random() & 0x1F;
-					if (waiting_avg < 200) dec &= 7;
-					waiting -= (dec + 1) * num_dests;
-					waiting_changed = true;
-				}
+		/* num_dests is at least 1 if there is any cargo as
+		 * INVALID_STATION is also a destination.
+		 */
+		uint num_dests = (uint)ge->cargo.Packets()->MapSize();
 
-				/* if rating is <= 127 and there are any items waiting, maybe remove some goods. */
-				if (rating <= 127 && waiting != 0) {
-					uint32 r = Random();
-					if (rating <= (int)GB(r, 0, 7)) {
-						/* Need to have int, otherwise it will just overflow etc. */
-						waiting = max((int)waiting - (int)((GB(r, 8, 2) - 1) * num_dests), 0);
-						waiting_changed = true;
-					}
-				}
+		/* Average amount of cargo per next hop, but prefer solitary stations
+		 * with only one or two next hops. They are allowed to have more
+		 * cargo waiting per next hop.
+		 * With manual cargo distribution waiting_avg = waiting / 2 as then
+		 * INVALID_STATION is the only destination.
+		 */
+		uint waiting_avg = waiting / (num_dests + 1);
+		bool waiting_changed = false;
+
+		uint16 callback = cargo_update.callback;
+		if (callback != CALLBACK_FAILED) {
+			skip = true;
+			rating = GB(callback, 0, 14);
+
+			/* Simulate a 15 bit signed value */
+			if (HasBit(callback, 14)) rating -= 0x4000;
+		}
+
+		if (!skip) {
+			int b = ge->last_speed - 85;
+			if (b >= 0) rating += b >> 2;
+
+			byte waittime = ge->time_since_pickup;
+			if (st->last_vehicle_type == VEH_SHIP) waittime >>= 2;
+			if (waittime <= 21) rating += 25;
+			if (waittime <= 12) rating += 25;
+			if (waittime <= 6) rating += 45;
+			if (waittime <= 3) rating += 35;
+
+			rating -= 90;
+			if (ge->max_waiting_cargo <= 1500) rating += 55;
+			if (ge->max_waiting_cargo <= 1000) rating += 35;
+			if (ge->max_waiting_cargo <= 600) rating += 10;
+			if (ge->max_waiting_cargo <= 300) rating += 20;
+			if (ge->max_waiting_cargo <= 100) rating += 10;
+		}
+
+		if (Company::IsValidID(st->owner) && HasBit(st->town->statues, st->owner)) rating += 26;
 
-				/* At some point we really must cap the cargo. Previously this
-				 * was a strict 4095, but now we'll have a less strict, but
-				 * increasingly aggressive truncation of the amount of cargo. */
-				static const uint WAITING_CARGO_THRESHOLD  = 1 << 12;
-				static const uint WAITING_CARGO_CUT_FACTOR = 1 <<  6;
-				static const uint MAX_WAITING_CARGO        = 1 << 15;
+		byte age = ge->last_age;
+		if (age < 3) rating += 10;
+		if (age < 2) rating += 10;
+		if (age < 1) rating += 13;
 
-				if (waiting > WAITING_CARGO_THRESHOLD) {
-					uint difference = waiting - WAITING_CARGO_THRESHOLD;
-					waiting -= (difference / WAITING_CARGO_CUT_FACTOR);
+		{
+			int or_ = ge->rating; // old rating
 
-					waiting = min(waiting, MAX_WAITING_CARGO);
+			/* only modify rating in steps of -2, -1, 0, 1 or 2 */
+			ge->rating = rating = or_ + Clamp(Clamp(rating, 0, 255) - or_, -2, 2);
+
+			/* if rating is <= 64 and more than 100 items waiting on average per destination,
+			 * remove some random amount of goods from the station */
+			if (rating <= 64 && waiting_avg >= 100) {
+				int dec = random.Next() & 0x1F;
+				if (waiting_avg < 200) dec &= 7;
+				waiting -= (dec + 1) * num_dests;
+				waiting_changed = true;
+			}
+
+			/* if rating is <= 127 and there are any items waiting, maybe remove some goods. */
+			if (rating <= 127 && waiting != 0) {
+				uint32 r = random.Next();
+				if (rating <= (int)GB(r, 0, 7)) {
+					/* Need to have int, otherwise it will just overflow etc. */
+					waiting = max((int)waiting - (int)((GB(r, 8, 2) - 1) * num_dests), 0);
 					waiting_changed = true;
 				}
+			}
 
-				/* We can't truncate cargo that's already reserved for loading.
-				 * Thus StoredCount() here. */
-				if (waiting_changed && waiting < ge->cargo.AvailableCount()) {
-					/* Feed back the exact own waiting cargo at this station for the
-					 * next rating calculation. */
-					ge->max_waiting_cargo = 0;
-
-					TruncateCargo(cs, ge, ge->cargo.AvailableCount() - waiting);
-				} else {
-					/* If the average number per next hop is low, be more forgiving. */
-					ge->max_waiting_cargo = waiting_avg;
-				}
+			/* At some point we really must cap the cargo. Previously this
+			 * was a strict 4095, but now we'll have a less strict, but
+			 * increasingly aggressive truncation of the amount of cargo. */
+			static const uint WAITING_CARGO_THRESHOLD  = 1 << 12;
+			static const uint WAITING_CARGO_CUT_FACTOR = 1 <<  6;
+			static const uint MAX_WAITING_CARGO        = 1 << 15;
+
+			if (waiting > WAITING_CARGO_THRESHOLD) {
+				uint difference = waiting - WAITING_CARGO_THRESHOLD;
+				waiting -= (difference / WAITING_CARGO_CUT_FACTOR);
+
+				waiting = min(waiting, MAX_WAITING_CARGO);
+				waiting_changed = true;
 			}
 		}
+
+		cargo_update.waiting = waiting;
+		cargo_update.waiting_avg = waiting_avg;
+		cargo_update.waiting_changed = waiting_changed;
+	}
+}
+
+/**
+ * Last phase of updating the rating of a station: remove the cargo that
+ * may not remain waiting, which also affects the source stations of that cargo.
+ * @param update The rating update of the station.
+ */
+static void ApplyStationRating(const StationRatingUpdate &update)
+{
+	bool waiting_changed = update.waiting_changed;
+
+	for (uint i = update.first; i != update.last; i++) {
+		const CargoRatingUpdate &cargo_update = _cargo_rating_updates[i];
+		GoodsEntry *ge = &update.st->goods[cargo_update.cargo];
+
+		/* We can't truncate cargo that's already reserved for loading.
+		 * Thus StoredCount() here. */
+		if (cargo_update.waiting_changed && cargo_update.waiting < ge->cargo.AvailableCount()) {
+			/* Feed back the exact own waiting cargo at this station for the
+			 * next rating calculation. */
+			ge->max_waiting_cargo = 0;
+
+			TruncateCargo(CargoSpec::Get(cargo_update.cargo), ge, ge->cargo.AvailableCount() - cargo_update.waiting);
+		} else {
+			/* If the average number per next hop is low, be more forgiving. */
+			ge->max_waiting_cargo = cargo_update.waiting_avg;
+		}
+		waiting_changed |= cargo_update.waiting_changed;
 	}
 
-	StationID index = st->index;
+	StationID index = update.st->index;
 	if (waiting_changed) {
 		SetWindowDirty(WC_STATION_VIEW, index); // update whole window
 	} else {
@@ -3614,6 +3699,26 @@ static void UpdateStationRating(Station *st)
 	}
 }
 
+/**
+ * Update the ratings of the stations prepared by PrepareStationRating during this tick.
+ * The ratings are calculated in parallel, after which the waiting cargo is truncated in station order.
+ */
+static void UpdateStationRatings()
+{
+	static ThreadPool thread_pool("ottd:rating");
+
+	uint count = (uint)_station_rating_updates.size();
+	thread_pool.Run(CeilDiv(count, STATION_RATINGS_PER_TASK), [count](uint index) {
+		uint last = min((index + 1) * STATION_RATINGS_PER_TASK, count);
+		for (uint i = index * STATION_RATINGS_PER_TASK; i < last; i++) ComputeStationRating(_station_rating_updates[i]);
+	});
+
+	for (const StationRatingUpdate &update : _station_rating_updates) ApplyStationRating(update);
+
+	_station_rating_updates.clear();
+	_cargo_rating_updates.clear();
+}
+
 /**
  * Reroute cargo of type c at station st or in any vehicles unloading there.
  * Make sure the cargo's new next hop is neither "avoid" nor "avoid2".
@@ -3814,16 +3919,17 @@ static void StationHandleSmallTick(BaseStation *st)
 	if (b >= STATION_RATING_TICKS) b = 0;
 	st->delete_ctr = b;
 
-	if (b == 0) UpdateStationRating(Station::From(st));
+	if (b == 0) PrepareStationRating(Station::From(st));
 }
 
 void OnTick_Station()
 {
 	if (_game_mode == GM_EDITOR) return;
 
-	for (BaseStation *st : BaseStation::Iterate()) {
-		StationHandleSmallTick(st);
+	for (BaseStation *st : BaseStation::Iterate()) StationHandleSmallTick(st);
+	UpdateStationRatings();
 
+	for (BaseStation *st : BaseStation::Iterate()) {
 		/* Clean up the link graph about once a week. */
 		if (Station::IsExpected(st) && (_tick_counter + st->index) % STATION_LINKGRAPH_TICKS == 0) {
 			DeleteStaleLinks(Station::From(st));
@@ -4761,4 +4867,5 @@ extern const TileTypeProcs _tile_type_station_procs = {
 	VehicleEnter_Station,       // vehicle_enter_tile_proc
 	GetFoundation_Station,      // get_foundation_proc
 	TerraformTile_Station,      // terraform_tile_proc
+	nullptr,                    // tile_loop_local_proc
 };
@@ -226,7 +226,9 @@ protected:
 
 		DEBUG(misc, 3, "Building station list for company %d", owner);
 
-		this->stations.clear();
+		/* Keep the previous order, so only the stations that are new to the list need sorting. */
+		std::vector<const Station *> previous;
+		previous.swap(this->stations);
 
 		for (const Station *st : Station::Iterate()) {
 			if (st->owner == owner || (st->owner == OWNER_NONE && HasStationInUse(st->index, true, owner))) {
@@ -250,7 +252,7 @@ protected:
 		}
 
 		this->stations.shrink_to_fit();
-		this->stations.RebuildDone();
+		this->stations.RebuildDone(previous);
 
 		this->vscroll->SetCount((uint)this->stations.size()); // Update the scrollbar
 	}
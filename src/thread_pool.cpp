@@ -0,0 +1,123 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file thread_pool.cpp Implementation of the pool of worker threads. */
+
+#include "stdafx.h"
+#include "thread.h"
+#include "thread_pool.h"
+
+#include "safeguards.h"
+
+/**
+ * Create a thread pool. The worker threads are only started by the first Run().
+ * @param name Name of the worker threads.
+ * @param max_workers Maximum number of worker threads, besides the thread calling Run().
+ */
+ThreadPool::ThreadPool(const char *name, uint max_workers) :
+	name(name), max_workers(max_workers), started(false), task(nullptr), count(0), generation(0), busy(0), quit(false), next(0)
+{
+}
+
+/** Stop and join all worker threads. */
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> guard(this->lock);
+		this->quit = true;
+	}
+	this->work_ready.notify_all();
+
+	for (std::thread &worker : this->workers) worker.join();
+}
+
+/** Start as many worker threads as there are additional hardware threads. */
+void ThreadPool::StartWorkers()
+{
+	this->started = true;
+
+	uint hardware_threads = std::thread::hardware_concurrency();
+	uint wanted = std::min(hardware_threads > 1 ? hardware_threads - 1 : 0, this->max_workers);
+
+	this->workers.reserve(wanted);
+	for (uint i = 0; i < wanted; i++) {
+		std::thread worker;
+		if (!StartNewThread(&worker, this->name, &ThreadPool::WorkerMain, this)) break;
+		this->workers.push_back(std::move(worker));
+	}
+
+	DEBUG(misc, 3, "Started %u worker threads for '%s'", (uint)this->workers.size(), this->name);
+}
+
+/**
+ * Run tasks of the current batch until there are no more left.
+ * @param task The task to run.
+ * @param count The number of tasks in the batch.
+ */
+void ThreadPool::RunTasks(const Task &task, uint count)
+{
+	for (uint index = this->next++; index < count; index = this->next++) task(index);
+}
+
+/**
+ * Main loop of the worker threads.
+ * @param pool The pool the worker belongs to.
+ */
+/* static */ void ThreadPool::WorkerMain(ThreadPool *pool)
+{
+	uint seen_generation = 0;
+
+	std::unique_lock<std::mutex> guard(pool->lock);
+	for (;;) {
+		pool->work_ready.wait(guard, [&]() { return pool->quit || (pool->task != nullptr && pool->generation != seen_generation); });
+		if (pool->quit) return;
+
+		seen_generation = pool->generation;
+		const Task &task = *pool->task;
+		uint count = pool->count;
+		pool->busy++;
+
+		guard.unlock();
+		pool->RunTasks(task, count);
+		guard.lock();
+
+		if (--pool->busy == 0) pool->work_done.notify_all();
+	}
+}
+
+/**
+ * Run a batch of tasks, and wait till all of them are done.
+ * The tasks may be run in any order and on any thread, so they must not
+ * depend on each other. Tasks must not throw, nor run batches themselves.
+ * @param count The number of tasks to run.
+ * @param task The task to run for every index in [0, count).
+ */
+void ThreadPool::Run(uint count, const Task &task)
+{
+	if (count == 0) return;
+	if (!this->started) this->StartWorkers();
+
+	this->next = 0;
+	if (count > 1 && !this->workers.empty()) {
+		{
+			std::lock_guard<std::mutex> guard(this->lock);
+			this->task = &task;
+			this->count = count;
+			this->generation++;
+		}
+		this->work_ready.notify_all();
+	}
+
+	this->RunTasks(task, count);
+
+	if (count > 1 && !this->workers.empty()) {
+		/* Stop workers from joining this batch late, then wait for the ones still busy. */
+		std::unique_lock<std::mutex> guard(this->lock);
+		this->task = nullptr;
+		this->work_done.wait(guard, [&]() { return this->busy == 0; });
+	}
+}
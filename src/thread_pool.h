@@ -0,0 +1,63 @@
+/*
+ * This file is part of OpenTTD.
+ * OpenTTD is free software; you can redistribute it and/or modify it under the terms of the GNU General Public License as published by the Free Software Foundation, version 2.
+ * OpenTTD is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details. You should have received a copy of the GNU General Public License along with OpenTTD. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file thread_pool.h A pool of worker threads to run batches of tasks in parallel. */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A set of worker threads which run batches of independent tasks in parallel.
+ * The thread starting a batch takes part in running it, and only returns once
+ * every task of the batch has been run. When no worker threads can be made,
+ * the batch is simply run on the calling thread.
+ */
+class ThreadPool {
+public:
+	/** A task of a batch; gets the index of the task within the batch. */
+	typedef std::function<void(uint index)> Task;
+
+	ThreadPool(const char *name, uint max_workers = UINT_MAX);
+	~ThreadPool();
+
+	void Run(uint count, const Task &task);
+
+	/**
+	 * Get the number of worker threads, not counting the thread calling Run().
+	 * @return The number of worker threads.
+	 */
+	uint GetWorkerCount() const { return (uint)this->workers.size(); }
+
+private:
+	const char *name;                   ///< Name of the worker threads.
+	uint max_workers;                   ///< Maximum number of worker threads to start.
+	bool started;                       ///< Whether we tried to start the worker threads.
+	std::vector<std::thread> workers;   ///< The worker threads.
+
+	std::mutex lock;                    ///< Lock for everything below.
+	std::condition_variable work_ready; ///< Signalled when a new batch is available, or when the workers have to stop.
+	std::condition_variable work_done;  ///< Signalled when the last worker leaves a batch.
+	const Task *task;                   ///< Task of the current batch, or \c nullptr when there is none.
+	uint count;                         ///< Number of tasks in the current batch.
+	uint generation;                    ///< Number of the current batch, so workers join each batch only once.
+	uint busy;                          ///< Number of workers still working on the current batch.
+	bool quit;                          ///< Whether the workers have to stop.
+	std::atomic<uint> next;             ///< Index of the next task to run in the current batch.
+
+	void StartWorkers();
+	void RunTasks(const Task &task, uint count);
+	static void WorkerMain(ThreadPool *pool);
+};
+
+#endif /* THREAD_POOL_H */
@@ -115,6 +115,17 @@ typedef void AddProducedCargoProc(TileIndex tile, CargoArray &produced);
 typedef bool ClickTileProc(TileIndex tile);
 typedef void AnimateTileProc(TileIndex tile);
 typedef void TileLoopProc(TileIndex tile);
+
+/**
+ * Tile callback function signature for running the tile loop of a tile, but
+ * only when it solely involves the tile itself. It may only change the tile
+ * itself, may only depend on the tile itself and the heights of the tiles
+ * around it, may not use the random generator and may not make the tile need
+ * redrawing. This makes it safe to call it for several tiles in parallel.
+ * @param tile The tile to run the tile loop for.
+ * @return Whether the tile loop has been run; if not, the tile is unchanged and TileLoopProc has to be called instead.
+ */
+typedef bool TileLoopLocalProc(TileIndex tile);
 typedef void ChangeTileOwnerProc(TileIndex tile, Owner old_owner, Owner new_owner);
 
 /** @see VehicleEnterTileStatus to see what the return values mean */
@@ -157,6 +168,7 @@ struct TileTypeProcs {
 	VehicleEnterTileProc *vehicle_enter_tile_proc; ///< Called when a vehicle enters a tile
 	GetFoundationProc *get_foundation_proc;
 	TerraformTileProc *terraform_tile_proc;        ///< Called when a terraforming operation is about to take place
+	TileLoopLocalProc *tile_loop_local_proc;       ///< Runs the tile loop of a tile when that solely involves the tile itself, or \c nullptr
 };
 
 extern const TileTypeProcs * const _tile_type_procs[16];
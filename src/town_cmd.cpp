@@ -3682,9 +3682,18 @@ CommandCost CheckforTownRating(DoCommandFlag flags, Town *t, TownRatingCheckType
 	return CommandCost();
 }
 
-void TownsMonthlyLoop()
+/**
+ * Monthly loop for towns. To prevent a lag spike at the start of the month,
+ * every town is handled on the tick of the first day of the month that
+ * matches its index.
+ * @param tick The tick of the first day of the month.
+ */
+void TownsMonthlyLoop(uint tick)
 {
-	for (Town *t : Town::Iterate()) {
+	for (size_t i = tick; i < Town::GetPoolSize(); i += DAY_TICKS) {
+		Town *t = Town::GetIfValid(i);
+		if (t == nullptr) continue;
+
 		if (t->road_build_months != 0) t->road_build_months--;
 
 		if (t->exclusive_counter != 0) {
@@ -3698,7 +3707,7 @@ void TownsMonthlyLoop()
 		UpdateTownCargoes(t);
 	}
 
-	UpdateTownCargoBitmap();
+	if (tick == DAY_TICKS - 1) UpdateTownCargoBitmap();
 }
 
 void TownsYearlyLoop()
@@ -3754,6 +3763,7 @@ extern const TileTypeProcs _tile_type_town_procs = {
 	nullptr,                    // vehicle_enter_tile_proc
 	GetFoundation_Town,      // get_foundation_proc
 	TerraformTile_Town,      // terraform_tile_proc
+	nullptr,                 // tile_loop_local_proc
 };
 
 
@@ -99,8 +99,11 @@ struct Train FINAL : public GroundVehicle<Train, VEH_TRAIN> {
 	/** Ticks waiting in front of a signal, ticks being stuck or a counter for forced proceeding through signals. */
 	uint16 wait_counter;
 
+	/** Tile of the reservation which blocked the last path reservation of this stuck train; it does not try again until that is released. INVALID_TILE when not waiting. */
+	TileIndex path_wait_tile;
+
 	/** We don't want GCC to zero our struct! It already is zeroed and has an index! */
-	Train() : GroundVehicleBase() {}
+	Train() : GroundVehicleBase(), path_wait_tile(INVALID_TILE) {}
 	/** We want to 'destruct' the right class. */
 	virtual ~Train() { this->PreDestructor(); }
 
@@ -50,6 +50,9 @@ static void CheckNextTrainTile(Train *v);
 static const byte _vehicle_initial_x_fract[4] = {10, 8, 4,  8};
 static const byte _vehicle_initial_y_fract[4] = { 8, 4, 8, 10};
 
+/** Number of path backoff intervals after which a train waiting for the release of a reservation retries anyway. */
+static const uint PATH_WAIT_RETRY_INTERVALS = 4;
+
 template <>
 bool IsValidImageIndex<VEH_TRAIN>(uint8 image_index)
 {
@@ -1490,6 +1493,7 @@ static void MarkTrainAsStuck(Train *v)
 		SetBit(v->flags, VRF_TRAIN_STUCK);
 
 		v->wait_counter = 0;
+		v->path_wait_tile = INVALID_TILE;
 
 		/* Stop train */
 		v->cur_speed = 0;
@@ -2198,6 +2202,8 @@ static void ClearPathReservation(const Train *v, TileIndex tile, Trackdir track_
 				/* Free the reservation only if no other train is on the tiles. */
 				SetTunnelBridgeReservation(tile, false);
 				SetTunnelBridgeReservation(end, false);
+				WakeTrainsWaitingForPath(tile);
+				WakeTrainsWaitingForPath(end);
 
 				if (_settings_client.gui.show_track_reservation) {
 					if (IsBridge(tile)) {
@@ -2718,7 +2724,10 @@ bool TryPathReserve(Train *v, bool mark_as_stuck, bool first_tile_okay)
 
 	if (!res_made) {
 		/* Free the depot reservation as well. */
-		if (v->track == TRACK_BIT_DEPOT) SetDepotReservation(v->tile, false);
+		if (v->track == TRACK_BIT_DEPOT) {
+			SetDepotReservation(v->tile, false);
+			WakeTrainsWaitingForPath(v->tile);
+		}
 		return false;
 	}
 
@@ -2928,6 +2937,7 @@ uint Train::Crash(bool flooded)
 				/* ClearPathReservation will not free the wormhole exit
 				 * if the train has just entered the wormhole. */
 				SetTunnelBridgeReservation(GetOtherTunnelBridgeEnd(v->tile), false);
+				WakeTrainsWaitingForPath(GetOtherTunnelBridgeEnd(v->tile));
 			}
 		}
 
@@ -3787,9 +3797,16 @@ static bool TrainLocoHandler(Train *v, bool mode)
 		bool turn_around = v->wait_counter % (_settings_game.pf.wait_for_pbs_path * DAY_TICKS) == 0 && _settings_game.pf.reverse_at_signals;
 
 		if (!turn_around && v->wait_counter % _settings_game.pf.path_backoff_interval != 0 && v->force_proceed == TFP_NONE) return true;
+		/* A train waiting for a known reservation to be released only retries once in a while, unless it got woken up. */
+		if (!turn_around && v->force_proceed == TFP_NONE && v->path_wait_tile != INVALID_TILE &&
+				v->wait_counter % (_settings_game.pf.path_backoff_interval * PATH_WAIT_RETRY_INTERVALS) != 0) return true;
+
+		_path_reservation_blocked_tile = INVALID_TILE;
 		if (!TryPathReserve(v)) {
 			/* Still stuck. */
 			if (turn_around) ReverseTrainDirection(v);
+			/* After turning around the train is no longer blocked by the same reservation. */
+			WaitForPathReservationRelease(v, turn_around ? INVALID_TILE : _path_reservation_blocked_tile);
 
 			if (HasBit(v->flags, VRF_TRAIN_STUCK) && v->wait_counter > 2 * _settings_game.pf.wait_for_pbs_path * DAY_TICKS) {
 				/* Show message to player. */
@@ -748,6 +748,37 @@ static void TileLoop_Trees(TileIndex tile)
 	MarkTileDirtyByTile(tile);
 }
 
+/**
+ * Tile loop of tree tiles for when it solely involves the tile itself; that is
+ * for trees that are only waiting to grow.
+ * @param tile The tile to run the tile loop for.
+ * @return Whether the tile loop has been run.
+ * @see TileLoopLocalProc
+ */
+static bool TileLoopLocal_Trees(TileIndex tile)
+{
+	if (HasGrfMiscBit(GMB_AMBIENT_SOUND_CALLBACK) || GetTreeGround(tile) == TREE_GROUND_SHORE) return false;
+
+	switch (_settings_game.game_creation.landscape) {
+		case LT_TROPIC:
+			if (GetTropicZone(tile) == TROPICZONE_RAINFOREST) return false;
+			if (GetTropicZone(tile) == TROPICZONE_DESERT && GetTreeGround(tile) != TREE_GROUND_SNOW_DESERT) return false;
+			break;
+
+		case LT_ARCTIC:
+			if (GetTreeGround(tile) == TREE_GROUND_SNOW_DESERT || GetTreeGround(tile) == TREE_GROUND_ROUGH_SNOW) return false;
+			if (GetTileZ(tile) + 1 >= GetSnowLine()) return false;
+			break;
+	}
+
+	uint counter = GetTreeCounter(tile);
+	if (counter == 15) return false;
+	if (counter == 7 && GetTreeGround(tile) == TREE_GROUND_GRASS && GetTreeDensity(tile) < 3) return false;
+
+	AddTreeCounter(tile, 1);
+	return true;
+}
+
 void OnTick_Trees()
 {
 	/* Don't place trees if that's not allowed */
@@ -812,4 +843,5 @@ extern const TileTypeProcs _tile_type_trees_procs = {
 	nullptr,                     // vehicle_enter_tile_proc
 	GetFoundation_Trees,      // get_foundation_proc
 	TerraformTile_Trees,      // terraform_tile_proc
+	TileLoopLocal_Trees,      // tile_loop_local_proc
 };
@@ -47,10 +47,12 @@
 #include "bridge_map.h"
 #include "tunnel_map.h"
 #include "depot_map.h"
+#include "pbs.h"
 #include "gamelog.h"
 #include "linkgraph/linkgraph.h"
 #include "linkgraph/refresh.h"
 #include "framerate_type.h"
+#include "console_func.h"
 
 #include "table/strings.h"
 
@@ -363,25 +365,32 @@ byte VehicleRandomBits()
 	return GB(Random(), 0, 8);
 }
 
-/* Size of the hash, 6 = 64 x 64, 7 = 128 x 128. Larger sizes will (in theory) reduce hash
- * lookup times at the expense of memory usage. */
-const int HASH_BITS = 7;
-const int HASH_SIZE = 1 << HASH_BITS;
-const int HASH_MASK = HASH_SIZE - 1;
-const int TOTAL_HASH_SIZE = 1 << (HASH_BITS * 2);
-const int TOTAL_HASH_MASK = TOTAL_HASH_SIZE - 1;
+/* Maximum size of the tile hash, in bits; 20 = 1024 x 1024. The hash scales with the map
+ * size up to this size, so vehicles on different tiles rarely share a chain. Larger sizes
+ * will (in theory) reduce hash lookup times at the expense of memory usage. */
+static const uint TILE_HASH_MAX_BITS = 20;
 
-/* Resolution of the hash, 0 = 1*1 tile, 1 = 2*2 tiles, 2 = 4*4 tiles, etc.
- * Profiling results show that 0 is fastest. */
-const int HASH_RES = 0;
+static uint _tile_hash_bits_x;                 ///< Number of bits of the X coordinate of a tile used by the tile hash.
+static uint _tile_hash_mask_x;                 ///< Mask for the X coordinate of a tile in the tile hash.
+static uint _tile_hash_mask_y;                 ///< Mask for the Y coordinate of a tile in the tile hash.
+static std::vector<Vehicle *> _vehicle_tile_hash; ///< The tile hash; chains of vehicles per (group of) tile(s).
 
-static Vehicle *_vehicle_tile_hash[TOTAL_HASH_SIZE];
+/**
+ * Get the chain of the tile hash for a tile.
+ * @param x The X coordinate of the tile.
+ * @param y The Y coordinate of the tile.
+ * @return The chain of vehicles.
+ */
+static inline Vehicle **GetVehicleTileHash(uint x, uint y)
+{
+	return &_vehicle_tile_hash[(x & _tile_hash_mask_x) | ((y & _tile_hash_mask_y) << _tile_hash_bits_x)];
+}
 
-static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, void *data, VehicleFromPosProc *proc, bool find_first)
+static Vehicle *VehicleFromTileHash(uint xl, uint yl, uint xu, uint yu, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	for (int y = yl; ; y = (y + (1 << HASH_BITS)) & (HASH_MASK << HASH_BITS)) {
-		for (int x = xl; ; x = (x + 1) & HASH_MASK) {
-			Vehicle *v = _vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
+	for (uint y = yl; ; y = (y + 1) & _tile_hash_mask_y) {
+		for (uint x = xl; ; x = (x + 1) & _tile_hash_mask_x) {
+			Vehicle *v = *GetVehicleTileHash(x, y);
 			for (; v != nullptr; v = v->hash_tile_next) {
 				Vehicle *a = proc(v, data);
 				if (find_first && a != nullptr) return a;
@@ -394,7 +403,6 @@ static Vehicle *VehicleFromTileHash(int xl, int yl, int xu, int yu, void *data,
 	return nullptr;
 }
 
-
 /**
  * Helper function for FindVehicleOnPos/HasVehicleOnPos.
  * @note Do not call this function directly!
@@ -411,10 +419,10 @@ static Vehicle *VehicleFromPosXY(int x, int y, void *data, VehicleFromPosProc *p
 	const int COLL_DIST = 6;
 
 	/* Hash area to scan is from xl,yl to xu,yu */
-	int xl = GB((x - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int xu = GB((x + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS);
-	int yl = GB((y - COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
-	int yu = GB((y + COLL_DIST) / TILE_SIZE, HASH_RES, HASH_BITS) << HASH_BITS;
+	uint xl = ((x - COLL_DIST) / TILE_SIZE) & _tile_hash_mask_x;
+	uint xu = ((x + COLL_DIST) / TILE_SIZE) & _tile_hash_mask_x;
+	uint yl = ((y - COLL_DIST) / TILE_SIZE) & _tile_hash_mask_y;
+	uint yu = ((y + COLL_DIST) / TILE_SIZE) & _tile_hash_mask_y;
 
 	return VehicleFromTileHash(xl, yl, xu, yu, data, proc, find_first);
 }
@@ -466,10 +474,7 @@ bool HasVehicleOnPosXY(int x, int y, void *data, VehicleFromPosProc *proc)
  */
 static Vehicle *VehicleFromPos(TileIndex tile, void *data, VehicleFromPosProc *proc, bool find_first)
 {
-	int x = GB(TileX(tile), HASH_RES, HASH_BITS);
-	int y = GB(TileY(tile), HASH_RES, HASH_BITS) << HASH_BITS;
-
-	Vehicle *v = _vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
+	Vehicle *v = *GetVehicleTileHash(TileX(tile), TileY(tile));
 	for (; v != nullptr; v = v->hash_tile_next) {
 		if (v->tile != tile) continue;
 
@@ -615,9 +620,7 @@ static void UpdateVehicleTileHash(Vehicle *v, bool remove)
 	if (remove) {
 		new_hash = nullptr;
 	} else {
-		int x = GB(TileX(v->tile), HASH_RES, HASH_BITS);
-		int y = GB(TileY(v->tile), HASH_RES, HASH_BITS) << HASH_BITS;
-		new_hash = &_vehicle_tile_hash[(x + y) & TOTAL_HASH_MASK];
+		new_hash = GetVehicleTileHash(TileX(v->tile), TileY(v->tile));
 	}
 
 	if (old_hash == new_hash) return;
@@ -668,11 +671,64 @@ static void UpdateVehicleViewportHash(Vehicle *v, int x, int y)
 	}
 }
 
+/**
+ * Empty the vehicle hashes, and size the tile hash for the current map.
+ */
 void ResetVehicleHash()
 {
 	for (Vehicle *v : Vehicle::Iterate()) { v->hash_tile_current = nullptr; }
 	memset(_vehicle_viewport_hash, 0, sizeof(_vehicle_viewport_hash));
-	memset(_vehicle_tile_hash, 0, sizeof(_vehicle_tile_hash));
+
+	/* Use a chain per tile, unless that makes the hash too large; then share
+	 * chains between tiles along the longest axis first. */
+	uint bits_x = MapLogX();
+	uint bits_y = MapLogY();
+	while (bits_x + bits_y > TILE_HASH_MAX_BITS) {
+		if (bits_x >= bits_y) {
+			bits_x--;
+		} else {
+			bits_y--;
+		}
+	}
+	_tile_hash_bits_x = bits_x;
+	_tile_hash_mask_x = (1 << bits_x) - 1;
+	_tile_hash_mask_y = (1 << bits_y) - 1;
+	_vehicle_tile_hash.assign((size_t)1 << (bits_x + bits_y), nullptr);
+}
+
+/**
+ * Print statistics about the lengths of the chains of a vehicle hash.
+ * @param name Name of the hash.
+ * @param hash The chains of the hash.
+ * @param size The number of chains in the hash.
+ * @param next Member of the vehicle pointing to the next vehicle in the chain.
+ */
+static void PrintVehicleHashStats(const char *name, Vehicle * const *hash, size_t size, Vehicle *Vehicle::*next)
+{
+	size_t used = 0;
+	size_t vehicles = 0;
+	size_t longest = 0;
+	for (size_t i = 0; i < size; i++) {
+		size_t length = 0;
+		for (const Vehicle *v = hash[i]; v != nullptr; v = v->*next) length++;
+		if (length == 0) continue;
+
+		used++;
+		vehicles += length;
+		longest = max(longest, length);
+	}
+
+	IConsolePrintF(CC_DEFAULT, "%s: " PRINTF_SIZE " chains, " PRINTF_SIZE " used, " PRINTF_SIZE " vehicles, %.2f average and " PRINTF_SIZE " longest chain length",
+			name, size, used, vehicles, used == 0 ? 0.0 : (double)vehicles / used, longest);
+}
+
+/**
+ * Print statistics about the vehicle hashes to the console.
+ */
+void ConPrintVehicleHashStats()
+{
+	PrintVehicleHashStats("Tile hash", _vehicle_tile_hash.data(), _vehicle_tile_hash.size(), &Vehicle::hash_tile_next);
+	PrintVehicleHashStats("Viewport hash", _vehicle_viewport_hash, lengthof(_vehicle_viewport_hash), &Vehicle::hash_viewport_next);
 }
 
 void ResetVehicleColourMap()
@@ -1444,6 +1500,7 @@ void VehicleEnterDepot(Vehicle *v)
 			SetWindowClassesDirty(WC_TRAINS_LIST);
 			/* Clear path reservation */
 			SetDepotReservation(t->tile, false);
+			WakeTrainsWaitingForPath(t->tile);
 			if (_settings_client.gui.show_track_reservation) MarkTileDirtyByTile(t->tile);
 
 			UpdateSignalsOnSegment(t->tile, INVALID_DIAGDIR, t->owner);
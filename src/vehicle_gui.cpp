@@ -126,11 +126,13 @@ void BaseVehicleListWindow::BuildVehicleList()
 
 	DEBUG(misc, 3, "Building vehicle list type %d for company %d given index %d", this->vli.type, this->vli.company, this->vli.index);
 
+	/* Keep the previous order, so only the vehicles that are new to the list need sorting. */
+	std::vector<const Vehicle *> previous(this->vehicles);
 	GenerateVehicleSortList(&this->vehicles, this->vli);
 
 	this->unitnumber_digits = GetUnitNumberDigits(this->vehicles);
 
-	this->vehicles.RebuildDone();
+	this->vehicles.RebuildDone(previous);
 	this->vscroll->SetCount((uint)this->vehicles.size());
 }
 
@@ -178,15 +180,15 @@ DropDownList BaseVehicleListWindow::BuildActionDropdownList(bool show_autoreplac
 	return list;
 }
 
-/* cached values for VehicleNameSorter to spare many GetString() calls */
-static const Vehicle *_last_vehicle[2] = { nullptr, nullptr };
+/* Names of the vehicles for VehicleNameSorter to spare many GetString() calls; only valid during a single sort. */
+static std::unordered_map<VehicleID, std::string> _vehicle_sort_names;
 
 void BaseVehicleListWindow::SortVehicleList()
 {
-	if (this->vehicles.Sort()) return;
+	if (!this->vehicles.Sort()) return;
 
 	/* invalidate cached values for name sorter - vehicle names could change */
-	_last_vehicle[0] = _last_vehicle[1] = nullptr;
+	_vehicle_sort_names.clear();
 }
 
 void DepotSortList(VehicleList *list)
@@ -1086,24 +1088,26 @@ static bool VehicleNumberSorter(const Vehicle * const &a, const Vehicle * const
 	return a->unitnumber < b->unitnumber;
 }
 
-/** Sort vehicles by their name */
-static bool VehicleNameSorter(const Vehicle * const &a, const Vehicle * const &b)
+/**
+ * Get the name of a vehicle for sorting by name.
+ * @param v The vehicle.
+ * @return The name, as cached for the current sort.
+ */
+static const char *GetVehicleSortName(const Vehicle *v)
 {
-	static char last_name[2][64];
-
-	if (a != _last_vehicle[0]) {
-		_last_vehicle[0] = a;
-		SetDParam(0, a->index);
-		GetString(last_name[0], STR_VEHICLE_NAME, lastof(last_name[0]));
-	}
+	auto it = _vehicle_sort_names.find(v->index);
+	if (it != _vehicle_sort_names.end()) return it->second.c_str();
 
-	if (b != _last_vehicle[1]) {
-		_last_vehicle[1] = b;
-		SetDParam(0, b->index);
-		GetString(last_name[1], STR_VEHICLE_NAME, lastof(last_name[1]));
-	}
+	char name[64];
+	SetDParam(0, v->index);
+	GetString(name, STR_VEHICLE_NAME, lastof(name));
+	return _vehicle_sort_names.emplace(v->index, name).first->second.c_str();
+}
 
-	int r = strnatcmp(last_name[0], last_name[1]); // Sort by name (natural sorting).
+/** Sort vehicles by their name */
+static bool VehicleNameSorter(const Vehicle * const &a, const Vehicle * const &b)
+{
+	int r = strnatcmp(GetVehicleSortName(a), GetVehicleSortName(b)); // Sort by name (natural sorting).
 	return (r != 0) ? r < 0: VehicleNumberSorter(a, b);
 }
 
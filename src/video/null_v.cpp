@@ -10,7 +10,31 @@
 #include "../stdafx.h"
 #include "../gfx_func.h"
 #include "../blitter/factory.hpp"
+#include "../framerate_type.h"
+#include "../string_func.h"
+#include "../date_func.h"
+#include "../core/random_func.hpp"
+#include "../saveload/saveload.h"
+#include "../saveload/saveload_filter.h"
+#include "../3rdparty/md5/md5.h"
+#include "../vehicle_base.h"
+#include "../station_base.h"
+#include "../town.h"
+#include "../industry.h"
+#include "../company_base.h"
+#include "../order_base.h"
+#include "../cargopacket.h"
+#include "../roadstop_base.h"
+#include "../depot_base.h"
+#include "../signs_base.h"
+#include "../object_base.h"
+#include "../linkgraph/linkgraph.h"
 #include "null_v.h"
+#include <chrono>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 
 #include "../safeguards.h"
 
@@ -25,6 +49,11 @@ const char *VideoDriver_Null::Start(const char * const *parm)
 #endif
 
 	this->ticks = GetDriverParamInt(parm, "ticks", 1000);
+	this->warmup_ticks = GetDriverParamInt(parm, "warmup", 0);
+	const char *report = GetDriverParam(parm, "report");
+	this->report = report != nullptr ? report : "";
+	const char *expected_hash = GetDriverParam(parm, "hash");
+	this->expected_hash = expected_hash != nullptr ? expected_hash : "";
 	_screen.width  = _screen.pitch = _cur_resolution.width;
 	_screen.height = _cur_resolution.height;
 	_screen.dst_ptr = nullptr;
@@ -40,14 +69,161 @@ void VideoDriver_Null::Stop() { }
 
 void VideoDriver_Null::MakeDirty(int left, int top, int width, int height) {}
 
+/** Save filter that only calculates the MD5 hash of the savegame. */
+struct HashSaveFilter : SaveFilter {
+	Md5 checksum;  ///< The hash of everything written so far.
+	uint8 *digest; ///< Where to store the hash once the savegame is complete.
+	bool finished; ///< Whether the hash has been stored.
+
+	/**
+	 * Create the hashing filter.
+	 * @param digest Where to store the hash once the savegame is complete.
+	 */
+	HashSaveFilter(uint8 *digest) : SaveFilter(nullptr), digest(digest), finished(false)
+	{
+	}
+
+	void Write(byte *buf, size_t len) override
+	{
+		this->checksum.Append(buf, len);
+	}
+
+	void Finish() override
+	{
+		if (this->finished) return;
+		this->checksum.Finish(this->digest);
+		this->finished = true;
+	}
+};
+
+/**
+ * Calculate a hash of the game state, by hashing the savegame of the current game.
+ * The savegame is not compressed, so the hash does not depend on the compression libraries.
+ * @param buf The buffer to write the hash to.
+ * @param last The last element in the buffer.
+ * @return Whether the game could be saved.
+ */
+static bool GetGameStateHash(char *buf, const char *last)
+{
+	char format[lengthof(_savegame_format)];
+	strecpy(format, _savegame_format, lastof(format));
+	strecpy(_savegame_format, "none", lastof(_savegame_format));
+
+	uint8 digest[16];
+	bool saved = SaveWithFilter(new HashSaveFilter(digest), false) == SL_OK;
+
+	strecpy(_savegame_format, format, lastof(_savegame_format));
+
+	if (!saved) return false;
+	md5sumToString(buf, last, digest);
+	return true;
+}
+
+/**
+ * Get the peak resident set size of the process.
+ * @return The peak resident set size in KiB, or -1 when it is not known.
+ */
+static int64 GetPeakMemoryUsage()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#	if defined(__APPLE__)
+	return usage.ru_maxrss / 1024;
+#	else
+	return usage.ru_maxrss;
+#	endif
+#else
+	return -1;
+#endif
+}
+
+/**
+ * Write the benchmark report as a JSON object.
+ * @param f The file to write to.
+ * @param wall_time_ms Real time it took to run the measured ticks, in milliseconds.
+ * @param state_hash Hash of the game state after the measured ticks, or \c nullptr when it is not known.
+ */
+void VideoDriver_Null::WriteReport(FILE *f, double wall_time_ms, const char *state_hash)
+{
+	fprintf(f, "{\n");
+	fprintf(f, "\t\"ticks\": %u,\n", this->ticks);
+	fprintf(f, "\t\"warmup_ticks\": %u,\n", this->warmup_ticks);
+	fprintf(f, "\t\"wall_time_ms\": %.3f,\n", wall_time_ms);
+
+	fprintf(f, "\t\"elements\": {");
+	WritePerformanceRecording(f);
+	fprintf(f, "\n\t},\n");
+
+	int64 peak_rss = GetPeakMemoryUsage();
+	if (peak_rss < 0) {
+		fprintf(f, "\t\"peak_rss_kb\": null,\n");
+	} else {
+		fprintf(f, "\t\"peak_rss_kb\": " OTTD_PRINTF64 ",\n", peak_rss);
+	}
+
+	fprintf(f, "\t\"pools\": {\n");
+	fprintf(f, "\t\t\"vehicles\": " PRINTF_SIZE ",\n", Vehicle::GetNumItems());
+	fprintf(f, "\t\t\"stations\": " PRINTF_SIZE ",\n", BaseStation::GetNumItems());
+	fprintf(f, "\t\t\"road_stops\": " PRINTF_SIZE ",\n", RoadStop::GetNumItems());
+	fprintf(f, "\t\t\"depots\": " PRINTF_SIZE ",\n", Depot::GetNumItems());
+	fprintf(f, "\t\t\"towns\": " PRINTF_SIZE ",\n", Town::GetNumItems());
+	fprintf(f, "\t\t\"industries\": " PRINTF_SIZE ",\n", Industry::GetNumItems());
+	fprintf(f, "\t\t\"objects\": " PRINTF_SIZE ",\n", Object::GetNumItems());
+	fprintf(f, "\t\t\"signs\": " PRINTF_SIZE ",\n", Sign::GetNumItems());
+	fprintf(f, "\t\t\"companies\": " PRINTF_SIZE ",\n", Company::GetNumItems());
+	fprintf(f, "\t\t\"orders\": " PRINTF_SIZE ",\n", Order::GetNumItems());
+	fprintf(f, "\t\t\"order_lists\": " PRINTF_SIZE ",\n", OrderList::GetNumItems());
+	fprintf(f, "\t\t\"cargo_packets\": " PRINTF_SIZE ",\n", CargoPacket::GetNumItems());
+	fprintf(f, "\t\t\"link_graphs\": " PRINTF_SIZE "\n", LinkGraph::GetNumItems());
+	fprintf(f, "\t},\n");
+
+	fprintf(f, "\t\"date\": %d,\n", _date);
+	fprintf(f, "\t\"random_state\": \"%08x%08x\",\n", _random.state[0], _random.state[1]);
+	if (state_hash == nullptr) {
+		fprintf(f, "\t\"state_hash\": null\n");
+	} else {
+		fprintf(f, "\t\"state_hash\": \"%s\"\n", state_hash);
+	}
+	fprintf(f, "}\n");
+}
+
 void VideoDriver_Null::MainLoop()
 {
 	uint i;
 
+	for (i = 0; i < this->warmup_ticks; i++) {
+		GameLoop();
+		UpdateWindows();
+	}
+
+	bool benchmark = !this->report.empty() || !this->expected_hash.empty();
+	if (benchmark) StartPerformanceRecording();
+	auto start_time = std::chrono::steady_clock::now();
+
 	for (i = 0; i < this->ticks; i++) {
 		GameLoop();
 		UpdateWindows();
 	}
+
+	if (!benchmark) return;
+
+	double wall_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+	StopPerformanceRecording();
+
+	char state_hash[33];
+	bool hashed = GetGameStateHash(state_hash, lastof(state_hash));
+
+	if (!this->report.empty()) {
+		FILE *f = fopen(this->report.c_str(), "w");
+		if (f == nullptr) usererror("Cannot write benchmark report to '%s'", this->report.c_str());
+		this->WriteReport(f, wall_time_ms, hashed ? state_hash : nullptr);
+		fclose(f);
+	}
+
+	if (!this->expected_hash.empty() && (!hashed || strcasecmp(state_hash, this->expected_hash.c_str()) != 0)) {
+		usererror("Game state hash %s differs from the expected %s", hashed ? state_hash : "(none)", this->expected_hash.c_str());
+	}
 }
 
 bool VideoDriver_Null::ChangeResolution(int w, int h) { return false; }
@@ -11,11 +11,17 @@
 #define VIDEO_NULL_H
 
 #include "video_driver.hpp"
+#include <string>
 
 /** The null video driver. */
 class VideoDriver_Null : public VideoDriver {
 private:
-	uint ticks; ///< Amount of ticks to run.
+	uint ticks;                ///< Amount of ticks to run.
+	uint warmup_ticks;         ///< Amount of ticks to run before measuring.
+	std::string report;        ///< File to write the benchmark report to, or empty when not benchmarking.
+	std::string expected_hash; ///< Game state hash the benchmark has to end with, or empty when not checked.
+
+	void WriteReport(FILE *f, double wall_time_ms, const char *state_hash);
 
 public:
 	const char *Start(const char * const *param) override;
@@ -63,6 +63,7 @@
 #include "stdafx.h"
 #include "landscape.h"
 #include "viewport_func.h"
+#include "smallmap_gui.h"
 #include "station_base.h"
 #include "waypoint_base.h"
 #include "town.h"
@@ -1943,6 +1944,7 @@ void MarkTileDirtyByTile(TileIndex tile, int bridge_level_offset, int tile_heigh
 			pt.y - MAX_TILE_EXTENT_TOP - ZOOM_LVL_BASE * TILE_HEIGHT * bridge_level_offset,
 			pt.x + MAX_TILE_EXTENT_RIGHT,
 			pt.y + MAX_TILE_EXTENT_BOTTOM);
+	MarkSmallMapTileDirty(tile);
 }
 
 /**
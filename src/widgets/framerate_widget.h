@@ -23,6 +23,8 @@ enum FramerateWindowWidgets {
 	WID_FRW_ALLOCSIZE,
 	WID_FRW_SEL_MEMORY,
 	WID_FRW_SCROLLBAR,
+	WID_FRW_SEL_NEWGRF,
+	WID_FRW_NEWGRF_COSTS,
 };
 
 /** Widgets of the #FrametimeGraphWindow class. */
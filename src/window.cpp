@@ -39,6 +39,9 @@
 #include "guitimer_func.h"
 #include "news_func.h"
 
+#include <algorithm>
+#include <map>
+
 #include "safeguards.h"
 
 /** Values for _settings_client.gui.auto_scrolling */
@@ -58,6 +61,12 @@ Window *_z_front_window = nullptr;
 /** List of windows opened at the screen sorted from the back. */
 Window *_z_back_window  = nullptr;
 
+/**
+ * Windows by window class, in the order they were opened.
+ * Deleted windows stay in here, with class #WC_INVALID, till they are freed.
+ */
+static std::map<WindowClass, std::vector<Window *>> _windows_by_class;
+
 /** If false, highlight is white, otherwise the by the widget defined colour. */
 bool _window_highlight_colour = false;
 
@@ -1442,6 +1451,37 @@ static void RemoveWindowFromZOrdering(Window *w)
 	w->z_front = w->z_back = nullptr;
 }
 
+/**
+ * Remove the deleted windows, which are about to be freed, from the index of windows by class.
+ */
+static void RemoveDeletedWindowsFromClassIndex()
+{
+	for (auto &pair : _windows_by_class) {
+		std::vector<Window *> &windows = pair.second;
+		windows.erase(std::remove_if(windows.begin(), windows.end(), [](const Window *w) { return w->window_class == WC_INVALID; }), windows.end());
+	}
+}
+
+/**
+ * Call a function for all windows of a given class.
+ * Windows opened by the function are visited as well, windows deleted by it are skipped.
+ * @param cls Window class.
+ * @param func The function to call with each window.
+ */
+template <typename F>
+static void ForAllWindowsOfClass(WindowClass cls, F func)
+{
+	auto it = _windows_by_class.find(cls);
+	if (it == _windows_by_class.end()) return;
+
+	/* Index based, as the function may open new windows of this class. */
+	const std::vector<Window *> &windows = it->second;
+	for (size_t i = 0; i < windows.size(); i++) {
+		Window *w = windows[i];
+		if (w->window_class == cls) func(w);
+	}
+}
+
 /**
  * On clicking on a window, make it the frontmost window of all windows with an equal
  * or lower z-priority. The window is marked dirty for a repaint
@@ -1495,6 +1535,7 @@ void Window::InitializeData(WindowNumber window_number)
 
 	/* Insert the window into the correct location in the z-ordering. */
 	AddWindowToZOrdering(this);
+	_windows_by_class[this->window_class].push_back(this);
 }
 
 /**
@@ -1929,6 +1970,7 @@ void UnInitWindowSystem()
 
 	_z_front_window = nullptr;
 	_z_back_window = nullptr;
+	_windows_by_class.clear();
 }
 
 /**
@@ -3093,12 +3135,17 @@ void InputLoop()
 	CheckSoftLimit();
 
 	/* Do the actual free of the deleted windows. */
+	bool removed_from_index = false;
 	for (Window *v = _z_front_window; v != nullptr; /* nothing */) {
 		Window *w = v;
 		v = v->z_back;
 
 		if (w->window_class != WC_INVALID) continue;
 
+		if (!removed_from_index) {
+			RemoveDeletedWindowsFromClassIndex();
+			removed_from_index = true;
+		}
 		RemoveWindowFromZOrdering(w);
 		free(w);
 	}
@@ -3217,10 +3264,9 @@ void UpdateWindows()
  */
 void SetWindowDirty(WindowClass cls, WindowNumber number)
 {
-	const Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls && w->window_number == number) w->SetDirty();
-	}
+	ForAllWindowsOfClass(cls, [number](const Window *w) {
+		if (w->window_number == number) w->SetDirty();
+	});
 }
 
 /**
@@ -3231,12 +3277,9 @@ void SetWindowDirty(WindowClass cls, WindowNumber number)
  */
 void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_index)
 {
-	const Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls && w->window_number == number) {
-			w->SetWidgetDirty(widget_index);
-		}
-	}
+	ForAllWindowsOfClass(cls, [number, widget_index](const Window *w) {
+		if (w->window_number == number) w->SetWidgetDirty(widget_index);
+	});
 }
 
 /**
@@ -3245,10 +3288,9 @@ void SetWindowWidgetDirty(WindowClass cls, WindowNumber number, byte widget_inde
  */
 void SetWindowClassesDirty(WindowClass cls)
 {
-	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) w->SetDirty();
-	}
+	ForAllWindowsOfClass(cls, [](const Window *w) {
+		w->SetDirty();
+	});
 }
 
 /**
@@ -3258,9 +3300,13 @@ void SetWindowClassesDirty(WindowClass cls)
  */
 void Window::InvalidateData(int data, bool gui_scope)
 {
-	this->SetDirty();
-	if (!gui_scope) {
-		/* Schedule GUI-scope invalidation for next redraw. */
+	if (gui_scope) {
+		this->SetDirty();
+	} else if (std::find(this->scheduled_invalidation_data.begin(), this->scheduled_invalidation_data.end(), data) == this->scheduled_invalidation_data.end()) {
+		/* Schedule GUI-scope invalidation for next redraw. When the same
+		 * invalidation is scheduled already, the window is already dirty
+		 * and will get the GUI-scope call once before it is drawn. */
+		this->SetDirty();
 		this->scheduled_invalidation_data.push_back(data);
 	}
 	this->OnInvalidateData(data, gui_scope);
@@ -3307,6 +3353,8 @@ void Window::ProcessHighlightedInvalidations()
  * That means some stuff requires to be executed immediately in command scope, while not everything may be executed in command
  * scope. While GUI-scope calls have no restrictions on what they may do, they cannot assume the game to still be in the state
  * when the invalidation was scheduled; passed IDs may have got invalid in the mean time.
+ * Scheduling the same invalidation-data again before it is executed does not schedule another GUI-scope call; so the
+ * GUI-scope calls may also be executed in a different order than they were scheduled in.
  *
  * Finally, note that invalidations triggered from commands or the game loop result in OnInvalidateData() being called twice.
  * Once in command-scope, once in GUI-scope. So make sure to not process differential-changes twice.
@@ -3318,12 +3366,9 @@ void Window::ProcessHighlightedInvalidations()
  */
 void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool gui_scope)
 {
-	Window *w;
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls && w->window_number == number) {
-			w->InvalidateData(data, gui_scope);
-		}
-	}
+	ForAllWindowsOfClass(cls, [number, data, gui_scope](Window *w) {
+		if (w->window_number == number) w->InvalidateData(data, gui_scope);
+	});
 }
 
 /**
@@ -3336,13 +3381,9 @@ void InvalidateWindowData(WindowClass cls, WindowNumber number, int data, bool g
  */
 void InvalidateWindowClassesData(WindowClass cls, int data, bool gui_scope)
 {
-	Window *w;
-
-	FOR_ALL_WINDOWS_FROM_BACK(w) {
-		if (w->window_class == cls) {
-			w->InvalidateData(data, gui_scope);
-		}
-	}
+	ForAllWindowsOfClass(cls, [data, gui_scope](Window *w) {
+		w->InvalidateData(data, gui_scope);
+	});
 }
 
 /**